@@ -123,7 +123,9 @@ public:
   }
   void write( TCPSegment& seg )
   {
-    _interface.send_datagram( wrap_tcp_in_ip( seg ), _next_hop );
+    for ( const auto& ip_dgram : wrap_tcp_in_ip( seg ) ) {
+      _interface.send_datagram( ip_dgram, _next_hop );
+    }
     send_pending();
   }
   void tick( const size_t ms_since_last_tick )
@@ -3,6 +3,7 @@
 #include "tcp_minnow_socket.hh"
 #include "tun.hh"
 
+#include <cerrno>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
@@ -16,6 +17,7 @@ using namespace std;
 
 constexpr const char* TUN_DFLT = "tun144";
 constexpr const char* LOCAL_ADDRESS_DFLT = "169.254.144.9";
+constexpr long MSS_MAX = 65535 - 20 - 20; // largest IPv4 datagram, less the IPv4 and TCP headers
 
 static void show_usage( const char* argv0, const char* msg )
 {
@@ -34,6 +36,10 @@ static void show_usage( const char* argv0, const char* msg )
 
        << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
 
+       << "   -m <mss>        Send and accept up to <mss> bytes per segment   " << TCPConfig::MAX_PAYLOAD_SIZE
+       << "\n"
+       << "   -g              Send super-segments, split into <mss> pieces    (off)\n\n"
+
        << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
 
        << "   -Lu <loss>      Set uplink loss to <rate> (float in 0..1)       (no loss)\n"
@@ -93,6 +99,22 @@ static tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const sp
       c_fsm.rt_timeout = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-m", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -m requires one argument." );
+      char* end = nullptr;
+      errno = 0;
+      const long mss = strtol( args[curr + 1], &end, 0 );
+      if ( errno != 0 or end == args[curr + 1] or *end != '\0' or mss < 1 or mss > MSS_MAX ) {
+        show_usage( args[0], ( "ERROR: -m requires a number from 1 to " + to_string( MSS_MAX ) + "." ).c_str() );
+        exit( 1 );
+      }
+      c_fsm.mss = static_cast<uint16_t>( mss );
+      curr += 2;
+
+    } else if ( strncmp( "-g", args[curr], 3 ) == 0 ) {
+      c_fsm.super_segments = true;
+      curr += 1;
+
     } else if ( strncmp( "-d", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       tundev = args[curr + 1];
@@ -23,6 +23,14 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_chunked)
+ttest(byte_stream_reserve)
+ttest(byte_stream_watermarks)
+ttest(byte_stream_autotune)
+ttest(byte_stream_storage)
+ttest(byte_stream_concurrent)
+add_test(NAME byte_stream_concurrent_tsan COMMAND byte_stream_concurrent_tsan)
+set_property(TEST byte_stream_concurrent_tsan PROPERTY FIXTURES_REQUIRED compile)
 
 ttest(reassembler_single)
 ttest(reassembler_cap)
@@ -31,12 +39,16 @@ ttest(reassembler_dup)
 ttest(reassembler_holes)
 ttest(reassembler_overlapping)
 ttest(reassembler_win)
+ttest(reassembler_slices)
+ttest(reassembler_memory)
+ttest(reassembler_stats)
 
 ttest(wrapping_integers_cmp)
 ttest(wrapping_integers_wrap)
 ttest(wrapping_integers_unwrap)
 ttest(wrapping_integers_roundtrip)
 ttest(wrapping_integers_extra)
+ttest(wrapping_integers_reference)
 
 ttest(recv_connect)
 ttest(recv_transmit)
@@ -45,6 +57,7 @@ ttest(recv_reorder)
 ttest(recv_reorder_more)
 ttest(recv_close)
 ttest(recv_special)
+ttest(recv_sack)
 
 ttest(send_connect)
 ttest(send_transmit)
@@ -53,6 +66,14 @@ ttest(send_window)
 ttest(send_ack)
 ttest(send_close)
 ttest(send_extra)
+ttest(send_congestion)
+ttest(send_rto)
+ttest(send_sack)
+ttest(send_recovery)
+ttest(send_pacing)
+ttest(send_mss)
+
+ttest(tcp_peer_autotune)
 
 ttest(net_interface)
 
@@ -66,7 +87,7 @@ add_custom_target (check1 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --s
 
 add_custom_target (check2 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^reassembler_|^wrapping|^recv')
 
-add_custom_target (check3 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^reassembler_|^wrapping|^recv|^send')
+add_custom_target (check3 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^byte_stream_|^reassembler_|^wrapping|^recv|^send|^tcp_peer')
 
 add_custom_target (check4 COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --stop-on-failure --timeout 12 -R '^net_interface')
 
@@ -90,3 +111,5 @@ set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
 stest(reassembler_speed_test)
+stest(wrapping_integers_speed_test)
+stest(sender_speed_test)
@@ -1,59 +1,252 @@
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
+#include <utility>
 
 #include "byte_stream.hh"
 
 using namespace std;
 
-ByteStream::ByteStream( uint64_t capacity ) : capacity_( capacity + 1 ), buffer_( string( capacity + 1, 0 ) ) {}
+static RingMemory::Policy ring_policy( ByteStream::Storage storage )
+{
+  switch ( storage ) {
+    case ByteStream::Storage::MappedRing:
+      return RingMemory::Policy::Mapped;
+    case ByteStream::Storage::HugePageRing:
+      return RingMemory::Policy::HugePages;
+    case ByteStream::Storage::MirroredRing:
+      return RingMemory::Policy::Mirrored;
+    default:
+      return RingMemory::Policy::Heap;
+  }
+}
 
-bool ByteStream::is_full() const
+ByteStream::ByteStream( uint64_t capacity, Storage storage ) : ByteStream( capacity, capacity, storage ) {}
+
+ByteStream::ByteStream( uint64_t initial_capacity, uint64_t max_capacity, Storage storage )
+  : capacity_( initial_capacity )
+  , storage_( storage )
+  , initial_capacity_( initial_capacity )
+  , max_capacity_( max( initial_capacity, max_capacity ) )
+  , buffer_( storage == Storage::Chunked ? 0 : initial_capacity, ring_policy( storage ) )
+{}
+
+void ByteStream::grow_for( uint64_t len )
 {
-  return ( tail_ + 1 ) % capacity_ == head_;
+  const uint64_t wanted = bytes_pushed_ - bytes_popped_ + len;
+  uint64_t capacity = capacity_;
+  while ( capacity < max_capacity_ && wanted * 2 > capacity ) {
+    capacity = min( max( capacity * 2, uint64_t { 1 } ), max_capacity_ );
+  }
+  if ( capacity != capacity_ ) {
+    resize( capacity );
+  }
 }
 
-bool ByteStream::is_empty() const
+void ByteStream::shrink_if_empty()
 {
-  return head_ == tail_;
+  if ( capacity_ > initial_capacity_ && bytes_pushed_ == bytes_popped_ ) {
+    resize( initial_capacity_ );
+  }
 }
 
-void ByteStream::push( char ch )
+void ByteStream::resize( uint64_t capacity )
 {
-  buffer_[tail_] = ch;
-  tail_ += 1;
-  if ( tail_ == capacity_ ) {
-    const size_t len = tail_ - head_;
-    std::copy( buffer_.begin() + static_cast<int64_t>( head_ ), buffer_.end(), buffer_.begin() );
+  if ( storage_ != Storage::Chunked ) {
+    // lay the buffered bytes out again from the start of a ring of the new size
+    const uint64_t buffered = bytes_pushed_ - bytes_popped_;
+    const uint64_t first = min( buffered, buffer_.contiguous( head_ ) );
+    RingMemory buffer { capacity, ring_policy( storage_ ) };
+    if ( buffered > 0 ) {
+      memcpy( buffer.data(), buffer_.data() + head_, first );
+      memcpy( buffer.data() + first, buffer_.data(), buffered - first );
+    }
+    buffer_ = move( buffer );
     head_ = 0;
-    tail_ = len;
+    tail_ = buffered == buffer_.size() ? 0 : buffered;
+  }
+  capacity_ = capacity;
+}
+
+void ByteStream::set_readable_callback( uint64_t low_water, function<void()> callback )
+{
+  readable_low_water_ = low_water;
+  on_readable_ = move( callback );
+}
+
+void ByteStream::set_writable_callback( uint64_t high_water, function<void()> callback )
+{
+  writable_high_water_ = high_water;
+  on_writable_ = move( callback );
+}
+
+void ByteStream::notify_readable( uint64_t buffered_before ) const
+{
+  const uint64_t buffered = bytes_pushed_ - bytes_popped_;
+  if ( on_readable_ && buffered_before < readable_low_water_ && buffered >= readable_low_water_ ) {
+    on_readable_();
+  }
+}
+
+void ByteStream::notify_writable( uint64_t available_before ) const
+{
+  const uint64_t available = capacity_ - ( bytes_pushed_ - bytes_popped_ );
+  if ( on_writable_ && available_before < writable_high_water_ && available >= writable_high_water_ ) {
+    on_writable_();
   }
 }
 
-char ByteStream::pop()
+void ByteStream::copy_in( string_view data )
 {
-  const char ch = buffer_[head_];
-  head_ = ( head_ + 1 ) % capacity_;
-  return ch;
+  const uint64_t len = data.size();
+  const uint64_t buffered_before = bytes_pushed_ - bytes_popped_;
+
+  // copy into the free region, which wraps around the end of the ring at most once (never, if mirrored)
+  const uint64_t first = min( len, buffer_.contiguous( tail_ ) );
+  memcpy( buffer_.data() + tail_, data.data(), first );
+  memcpy( buffer_.data(), data.data() + first, len - first );
+  tail_ += len;
+  if ( tail_ >= buffer_.size() ) {
+    tail_ -= buffer_.size();
+  }
+  bytes_pushed_ += len;
+  notify_readable( buffered_before );
 }
 
 void Writer::push( const string& data )
 {
-  for ( const char ch : data ) {
-    if ( ByteStream::is_full() ) {
-      return;
+  grow_for( data.size() );
+  const uint64_t len = min( static_cast<uint64_t>( data.size() ), available_capacity() );
+  if ( len == 0 ) {
+    return;
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    push( Buffer { data.substr( 0, len ) } );
+    return;
+  }
+
+  copy_in( string_view( data ).substr( 0, len ) );
+}
+
+void Writer::push( string&& data )
+{
+  if ( storage_ != Storage::Chunked ) {
+    push( as_const( data ) );
+    return;
+  }
+
+  grow_for( data.size() );
+  const uint64_t len = min( static_cast<uint64_t>( data.size() ), available_capacity() );
+  if ( len == 0 ) {
+    return;
+  }
+
+  data.resize( len );
+  // don't let a mostly-unused read buffer pin its whole allocation
+  if ( data.capacity() / 2 > len ) {
+    data.shrink_to_fit();
+  }
+  push( Buffer { move( data ) } );
+}
+
+void Writer::push( Buffer data )
+{
+  grow_for( data.size() );
+  const uint64_t len = min( static_cast<uint64_t>( data.size() ), available_capacity() );
+  if ( len == 0 ) {
+    return;
+  }
+
+  if ( storage_ != Storage::Chunked ) {
+    copy_in( string_view( data ).substr( 0, len ) );
+    return;
+  }
+
+  const uint64_t buffered_before = bytes_pushed_ - bytes_popped_;
+  chunks_.push_back( len < data.size() ? data.substr( 0, len ) : move( data ) );
+  bytes_pushed_ += len;
+  notify_readable( buffered_before );
+}
+
+vector<span<char>> Writer::reserve( uint64_t len )
+{
+  len = min( len, available_capacity() );
+  reserved_ = 0;
+  if ( len == 0 ) {
+    return {};
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    // start the pool over if no pushed slice still refers to it; replace it if too little of it is left
+    if ( reserve_pool_ and reserve_pool_.use_count() == 1 ) {
+      reserve_offset_ = 0;
     }
-    bytes_pushed_ += 1;
-    ByteStream::push( ch );
+    if ( not reserve_pool_ or RESERVE_POOL_SIZE - reserve_offset_ < min( len, RESERVE_POOL_SIZE / 4 ) ) {
+      reserve_pool_ = make_shared<string>( RESERVE_POOL_SIZE, '\0' );
+      reserve_offset_ = 0;
+    }
+    reserved_ = min( len, RESERVE_POOL_SIZE - reserve_offset_ );
+    return { span<char> { reserve_pool_->data() + reserve_offset_, reserved_ } };
+  }
+
+  reserved_ = len;
+  const uint64_t first = min( len, buffer_.contiguous( tail_ ) );
+  vector<span<char>> ret { span<char> { buffer_.data() + tail_, first } };
+  if ( len > first ) {
+    ret.emplace_back( buffer_.data(), len - first );
   }
+  return ret;
+}
+
+void Writer::commit( uint64_t len )
+{
+  // only what reserve() handed out can have been written
+  len = min( len, static_cast<uint64_t>( reserved_ ) );
+  reserved_ = 0;
+
+  if ( storage_ == Storage::Chunked ) {
+    if ( len > 0 ) {
+      push( Buffer { reserve_pool_ }.substr( reserve_offset_, len ) );
+      reserve_offset_ += len;
+    }
+    return;
+  }
+
+  const uint64_t buffered_before = bytes_pushed_ - bytes_popped_;
+  tail_ += len;
+  if ( tail_ >= buffer_.size() ) {
+    tail_ -= buffer_.size();
+  }
+  bytes_pushed_ += len;
+  notify_readable( buffered_before );
+
+  // the reservation can't grow the stream (that would move the reserved space), so catch up now
+  grow_for( 0 );
 }
 
 void Writer::close()
 {
+  const bool was_closed = is_closed_;
   is_closed_ = true;
+  if ( on_readable_ && !was_closed ) {
+    on_readable_();
+  }
 }
 
 void Writer::set_error()
 {
+  const bool had_error = has_error_;
   has_error_ = true;
+  if ( had_error ) {
+    return;
+  }
+  if ( on_readable_ ) {
+    on_readable_();
+  }
+  if ( on_writable_ ) {
+    on_writable_();
+  }
 }
 
 bool Writer::is_closed() const
@@ -63,7 +256,7 @@ bool Writer::is_closed() const
 
 uint64_t Writer::available_capacity() const
 {
-  return capacity_ - ( tail_ + capacity_ - head_ ) % capacity_ - 1;
+  return capacity_ - ( bytes_pushed_ - bytes_popped_ );
 }
 
 uint64_t Writer::bytes_pushed() const
@@ -73,7 +266,73 @@ uint64_t Writer::bytes_pushed() const
 
 string_view Reader::peek() const
 {
-  return { buffer_.begin() + static_cast<int64_t>( head_ ), buffer_.begin() + static_cast<int64_t>( tail_ ) };
+  const uint64_t buffered = bytes_buffered();
+  if ( buffered == 0 ) {
+    return {};
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    return string_view( chunks_.front() ).substr( chunk_offset_ );
+  }
+
+  // only the part up to the end of the ring is contiguous (all of it, if mirrored)
+  return { buffer_.data() + head_, min( buffered, buffer_.contiguous( head_ ) ) };
+}
+
+Buffer Reader::peek_buffer( uint64_t len ) const
+{
+  len = min( len, bytes_buffered() );
+  if ( len == 0 ) {
+    return {};
+  }
+
+  if ( storage_ == Storage::Chunked ) {
+    if ( chunks_.front().size() - chunk_offset_ >= len ) {
+      return chunks_.front().substr( chunk_offset_, len );
+    }
+
+    // the bytes span several chunks, so they have to be gathered into a new one
+    string ret;
+    ret.reserve( len );
+    size_t offset = chunk_offset_;
+    for ( auto it = chunks_.begin(); ret.size() < len; ++it ) {
+      ret += string_view( *it ).substr( offset, len - ret.size() );
+      offset = 0;
+    }
+    return ret;
+  }
+
+  string ret;
+  ret.reserve( len );
+  const uint64_t first = min( len, buffer_.contiguous( head_ ) );
+  ret.append( buffer_.data() + head_, first );
+  ret.append( buffer_.data(), len - first );
+  return ret;
+}
+
+vector<string_view> Reader::peek_iovecs( uint64_t max_bytes ) const
+{
+  vector<string_view> ret;
+  uint64_t remaining = min( max_bytes, bytes_buffered() );
+
+  if ( storage_ == Storage::Chunked ) {
+    size_t offset = chunk_offset_;
+    for ( auto it = chunks_.begin(); remaining > 0; ++it ) {
+      ret.push_back( string_view( *it ).substr( offset, remaining ) );
+      remaining -= ret.back().size();
+      offset = 0;
+    }
+    return ret;
+  }
+
+  if ( remaining > 0 ) {
+    const uint64_t first = min( remaining, buffer_.contiguous( head_ ) );
+    ret.emplace_back( buffer_.data() + head_, first );
+    if ( remaining > first ) {
+      ret.emplace_back( buffer_.data(), remaining - first );
+    }
+  }
+  return ret;
 }
 
 bool Reader::is_finished() const
@@ -88,18 +347,29 @@ bool Reader::has_error() const
 
 void Reader::pop( uint64_t len )
 {
-  for ( uint64_t i = 0; i < len; ++i ) {
-    if ( ByteStream::is_empty() ) {
-      return;
+  len = min( len, bytes_buffered() );
+  const uint64_t available_before = capacity_ - bytes_buffered();
+  bytes_popped_ += len;
+
+  if ( storage_ == Storage::Chunked ) {
+    chunk_offset_ += len;
+    while ( !chunks_.empty() && chunk_offset_ >= chunks_.front().size() ) {
+      chunk_offset_ -= chunks_.front().size();
+      chunks_.pop_front();
+    }
+  } else {
+    head_ += len;
+    if ( head_ >= buffer_.size() ) {
+      head_ -= buffer_.size();
     }
-    bytes_popped_ += 1;
-    ByteStream::pop();
   }
+
+  notify_writable( available_before );
 }
 
 uint64_t Reader::bytes_buffered() const
 {
-  return ( tail_ + capacity_ - head_ ) % capacity_;
+  return bytes_pushed_ - bytes_popped_;
 }
 
 uint64_t Reader::bytes_popped() const
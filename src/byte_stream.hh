@@ -1,21 +1,66 @@
 #pragma once
 
+#include "buffer.hh"
+#include "ring_memory.hh"
+
+#include <deque>
+#include <functional>
+#include <memory>
 #include <queue>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <vector>
 
+class FileDescriptor;
 class Reader;
 class Writer;
 
 class ByteStream
 {
+public:
+  // How the ByteStream stores buffered bytes:
+  //   Ring: a preallocated ring of `capacity` bytes that every push is copied into.
+  //   MappedRing: a Ring in page-aligned mmap(2)ed memory.
+  //   HugePageRing: a MappedRing that also asks the kernel for transparent huge pages.
+  //   MirroredRing: a MappedRing whose pages are mapped twice back to back (a "magic ring buffer"),
+  //                 so the buffered bytes are always contiguous and peek() returns all of them.
+  //   Chunked: a queue of refcounted chunks; strings pushed by rvalue are adopted without a copy.
+  enum class Storage
+  {
+    Ring,
+    MappedRing,
+    HugePageRing,
+    MirroredRing,
+    Chunked
+  };
+
 protected:
   uint64_t capacity_;
+  Storage storage_;
+  // Autotuning: capacity_ grows from initial_capacity_ up to max_capacity_ (equal for a fixed-size stream)
+  uint64_t initial_capacity_;
+  uint64_t max_capacity_;
   // Please add any additional state to the ByteStream here, and not to the Writer and Reader interfaces.
+  // Ring storage: `buffer_` is a ring of at least `capacity_` bytes: the unread bytes start at `head_` and
+  // end (exclusive) at `tail_`, wrapping around the end of the ring at most once.
   std::size_t head_ { 0 };
   std::size_t tail_ { 0 };
-  std::string buffer_;
+  RingMemory buffer_;
+
+  // Chunked storage: the unread bytes are `chunks_`, minus the first `chunk_offset_` bytes of the front chunk.
+  std::deque<Buffer> chunks_ {};
+  std::size_t chunk_offset_ { 0 };
+
+  // Writer::reserve() hands out space that commit() then publishes, up to the length of the reservation
+  std::size_t reserved_ { 0 };
+
+  // Chunked storage: the reserved space is in a pooled chunk, and commit() pushes a slice of it.
+  // The pool is reused from the start once nothing refers to it any more.
+  static constexpr size_t RESERVE_POOL_SIZE = 65536;
+  std::shared_ptr<std::string> reserve_pool_ {};
+  std::size_t reserve_offset_ { 0 }; // where the current reservation starts
 
   uint64_t bytes_pushed_ = 0;
   uint64_t bytes_popped_ = 0;
@@ -24,14 +69,33 @@ protected:
   bool is_closed_ = false;
   bool is_finished_ = false;
 
-  char pop();
-  void push( char ch );
+  uint64_t readable_low_water_ { 1 };
+  std::function<void()> on_readable_ {};
+  uint64_t writable_high_water_ { 1 };
+  std::function<void()> on_writable_ {};
 
-  bool is_full() const;
-  bool is_empty() const;
+  void notify_readable( uint64_t buffered_before ) const;  // call after bytes are pushed
+  void notify_writable( uint64_t available_before ) const; // call after bytes are popped
+
+  void grow_for( uint64_t len );         // call before pushing `len` bytes
+  void copy_in( std::string_view data ); // ring storage: copy `data`, which must fit, after the buffered bytes
+  void resize( uint64_t capacity );
 
 public:
-  explicit ByteStream( uint64_t capacity );
+  explicit ByteStream( uint64_t capacity, Storage storage = Storage::Ring );
+
+  // An autotuned stream: it starts at `initial_capacity` and doubles (up to `max_capacity`) whenever a push
+  // would leave it more than half full, i.e. when the reader falls behind.
+  ByteStream( uint64_t initial_capacity, uint64_t max_capacity, Storage storage = Storage::Ring );
+
+  // If the stream is empty, give back any capacity it grew beyond its initial capacity
+  void shrink_if_empty();
+
+  // Optional readiness notifications, for consumers that would rather be told than poll.
+  // `callback` runs when a push makes bytes_buffered() rise to `low_water` (or when the stream closes),
+  // or respectively when a pop makes available_capacity() rise to `high_water`; either runs on error.
+  void set_readable_callback( uint64_t low_water, std::function<void()> callback );
+  void set_writable_callback( uint64_t high_water, std::function<void()> callback );
 
   // Helper functions (provided) to access the ByteStream's Reader and Writer interfaces
   Reader& reader();
@@ -44,6 +108,14 @@ class Writer : public ByteStream
 {
 public:
   void push( const std::string& data ); // Push data to stream, but only as much as available capacity allows.
+  void push( std::string&& data );      // Same, but Chunked storage adopts `data` instead of copying it.
+  void push( Buffer data );             // Same, but Chunked storage shares `data` instead of copying it.
+
+  // Writable space for up to `len` more bytes (as much as available capacity allows), in stream order.
+  // Fill a prefix of it and publish that prefix with commit() (which publishes no more than was reserved);
+  // no other push may come in between.
+  std::vector<std::span<char>> reserve( uint64_t len );
+  void commit( uint64_t len );
 
   void close();     // Signal that the stream has reached its ending. Nothing more will be written.
   void set_error(); // Signal that the stream suffered an error.
@@ -56,8 +128,13 @@ public:
 class Reader : public ByteStream
 {
 public:
-  std::string_view peek() const; // Peek at the next bytes in the buffer
-  void pop( uint64_t len );      // Remove `len` bytes from the buffer
+  std::string_view peek() const;            // Peek at the next bytes in the buffer
+  Buffer peek_buffer( uint64_t len ) const; // Peek at up to `len` next bytes, sharing storage if in one chunk
+
+  // Peek at up to `max_bytes` next bytes as every contiguous region they occupy, in order
+  std::vector<std::string_view> peek_iovecs( uint64_t max_bytes = UINT64_MAX ) const;
+
+  void pop( uint64_t len ); // Remove `len` bytes from the buffer
 
   bool is_finished() const; // Is the stream finished (closed and fully popped)?
   bool has_error() const;   // Has the stream had an error?
@@ -71,3 +148,10 @@ public:
  * from a ByteStream Reader into a string;
  */
 void read( Reader& reader, uint64_t len, std::string& out );
+
+/*
+ * read_into: A helper function that reads from a file descriptor straight into
+ * the free space of a ByteStream Writer, as much as its available capacity allows;
+ * returns the number of bytes read.
+ */
+size_t read_into( FileDescriptor& fd, Writer& writer );
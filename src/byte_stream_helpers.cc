@@ -1,4 +1,5 @@
 #include "byte_stream.hh"
+#include "file_descriptor.hh"
 
 #include <cstdint>
 #include <stdexcept>
@@ -24,6 +25,22 @@ void read( Reader& reader, uint64_t len, std::string& out )
   }
 }
 
+/*
+ * read_into: reads straight into the space Writer::reserve() hands out, so nothing is
+ * copied on the way into the stream.
+ */
+size_t read_into( FileDescriptor& fd, Writer& writer )
+{
+  const auto spans = writer.reserve( writer.available_capacity() );
+  if ( spans.empty() ) {
+    return 0;
+  }
+
+  const size_t bytes_read = fd.read( spans );
+  writer.commit( bytes_read );
+  return bytes_read;
+}
+
 Reader& ByteStream::reader()
 {
   static_assert( sizeof( Reader ) == sizeof( ByteStream ),
@@ -0,0 +1,92 @@
+#include "concurrent_byte_stream.hh"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+ConcurrentByteStream::ConcurrentByteStream( uint64_t capacity )
+  : capacity_( capacity ), buffer_( make_unique<char[]>( capacity ) )
+{}
+
+void ConcurrentByteStream::push( string_view data )
+{
+  // only this thread stores bytes_pushed_, so a relaxed load of it is up to date
+  const uint64_t pushed = bytes_pushed_.load( memory_order_relaxed );
+  const uint64_t free_space = capacity_ - ( pushed - bytes_popped_.load( memory_order_acquire ) );
+  const uint64_t len = min( static_cast<uint64_t>( data.size() ), free_space );
+  if ( len == 0 ) {
+    return;
+  }
+
+  const uint64_t tail = pushed % capacity_;
+  const uint64_t first = min( len, capacity_ - tail );
+  memcpy( buffer_.get() + tail, data.data(), first );
+  memcpy( buffer_.get(), data.data() + first, len - first );
+  bytes_pushed_.store( pushed + len, memory_order_release );
+}
+
+void ConcurrentByteStream::close()
+{
+  is_closed_.store( true, memory_order_release );
+}
+
+void ConcurrentByteStream::set_error()
+{
+  has_error_.store( true, memory_order_release );
+}
+
+bool ConcurrentByteStream::is_closed() const
+{
+  return is_closed_.load( memory_order_acquire );
+}
+
+uint64_t ConcurrentByteStream::available_capacity() const
+{
+  return capacity_ - ( bytes_pushed_.load( memory_order_relaxed ) - bytes_popped_.load( memory_order_acquire ) );
+}
+
+uint64_t ConcurrentByteStream::bytes_pushed() const
+{
+  return bytes_pushed_.load( memory_order_relaxed );
+}
+
+string_view ConcurrentByteStream::peek() const
+{
+  const uint64_t popped = bytes_popped_.load( memory_order_relaxed );
+  const uint64_t buffered = bytes_pushed_.load( memory_order_acquire ) - popped;
+  if ( buffered == 0 ) {
+    return {};
+  }
+
+  const uint64_t head = popped % capacity_;
+  return { buffer_.get() + head, min( buffered, capacity_ - head ) };
+}
+
+void ConcurrentByteStream::pop( uint64_t len )
+{
+  const uint64_t popped = bytes_popped_.load( memory_order_relaxed );
+  len = min( len, bytes_pushed_.load( memory_order_acquire ) - popped );
+  bytes_popped_.store( popped + len, memory_order_release );
+}
+
+bool ConcurrentByteStream::is_finished() const
+{
+  // read the flag first: once the writer has closed, every byte it pushed is visible
+  return is_closed_.load( memory_order_acquire ) && bytes_buffered() == 0;
+}
+
+bool ConcurrentByteStream::has_error() const
+{
+  return has_error_.load( memory_order_acquire );
+}
+
+uint64_t ConcurrentByteStream::bytes_buffered() const
+{
+  return bytes_pushed_.load( memory_order_acquire ) - bytes_popped_.load( memory_order_relaxed );
+}
+
+uint64_t ConcurrentByteStream::bytes_popped() const
+{
+  return bytes_popped_.load( memory_order_relaxed );
+}
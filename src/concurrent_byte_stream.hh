@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+/*
+ * A ByteStream for one writer thread and one reader thread: the writer may call push(), close(),
+ * set_error() and the writer-side accessors while the reader concurrently calls peek(), pop() and the
+ * reader-side accessors, with no external lock.
+ *
+ * The writer owns `bytes_pushed_` and the reader owns `bytes_popped_`; each is published with a release store
+ * and observed by the other side with an acquire load, so bytes in the ring are always written before they
+ * become visible and read before their space is handed back. The two counters live on separate cache lines
+ * so that the threads don't invalidate each other's line on every update.
+ */
+class ConcurrentByteStream
+{
+  static constexpr std::size_t cache_line_size = 64;
+
+  uint64_t capacity_;
+  std::unique_ptr<char[]> buffer_;
+
+  alignas( cache_line_size ) std::atomic<uint64_t> bytes_pushed_ { 0 };
+  alignas( cache_line_size ) std::atomic<uint64_t> bytes_popped_ { 0 };
+
+  alignas( cache_line_size ) std::atomic<bool> has_error_ { false };
+  std::atomic<bool> is_closed_ { false };
+
+public:
+  explicit ConcurrentByteStream( uint64_t capacity );
+
+  // Writer side
+  void push( std::string_view data ); // Push data to stream, but only as much as available capacity allows.
+  void close();                       // Signal that the stream has reached its ending.
+  void set_error();                   // Signal that the stream suffered an error.
+
+  bool is_closed() const;              // Has the stream been closed?
+  uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
+  uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
+
+  // Reader side
+  std::string_view peek() const; // Peek at the next bytes in the buffer
+  void pop( uint64_t len );      // Remove `len` bytes from the buffer
+
+  bool is_finished() const; // Is the stream finished (closed and fully popped)?
+  bool has_error() const;   // Has the stream had an error?
+
+  uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
+  uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
+};
@@ -0,0 +1,216 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+unique_ptr<CongestionController> make_congestion_controller( CongestionControl algorithm, uint64_t mss )
+{
+  switch ( algorithm ) {
+    case CongestionControl::NewReno:
+      return make_unique<NewReno>( mss );
+    case CongestionControl::Cubic:
+      return make_unique<Cubic>( mss );
+    case CongestionControl::BBR:
+      return make_unique<BBR>( mss );
+    case CongestionControl::None:
+      break;
+  }
+  return nullptr;
+}
+
+// RFC 5681 initial window
+NewReno::NewReno( uint64_t mss ) : mss_( mss ), cwnd_( min( 4 * mss, max( 2 * mss, uint64_t { 4380 } ) ) ) {}
+
+// pace a window per round trip, with headroom to keep growing (as Linux does)
+uint64_t NewReno::pacing_rate( optional<uint64_t> srtt_ms ) const
+{
+  if ( srtt_ms.value_or( 0 ) == 0 ) {
+    return 0;
+  }
+  const double gain = cwnd_ < ssthresh_ ? 2.0 : 1.2;
+  const auto srtt = static_cast<double>( srtt_ms.value() );
+  return static_cast<uint64_t>( gain * static_cast<double>( cwnd_ ) * 1000 / srtt );
+}
+
+void NewReno::on_ack( uint64_t acked_bytes,
+                      uint64_t /* bytes_in_flight */,
+                      uint64_t /* now_ms */,
+                      optional<uint64_t> /* rtt_ms */,
+                      optional<uint64_t> /* srtt_ms */ )
+{
+  if ( cwnd_ < ssthresh_ ) {
+    // slow start: at most one MSS per acknowledgment
+    cwnd_ += min( acked_bytes, mss_ );
+    return;
+  }
+
+  // congestion avoidance: one MSS per window's worth of acknowledged data
+  bytes_acked_ += acked_bytes;
+  if ( bytes_acked_ >= cwnd_ ) {
+    bytes_acked_ -= cwnd_;
+    cwnd_ += mss_;
+  }
+}
+
+void NewReno::on_loss( uint64_t bytes_in_flight, uint64_t /* now_ms */ )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = ssthresh_;
+  bytes_acked_ = 0;
+}
+
+void NewReno::on_rto( uint64_t bytes_in_flight, uint64_t /* now_ms */ )
+{
+  ssthresh_ = max( bytes_in_flight / 2, 2 * mss_ );
+  cwnd_ = mss_;
+  bytes_acked_ = 0;
+}
+
+// remember where the loss happened (a little lower if the last loss was even higher, to yield to new flows)
+void Cubic::reduce()
+{
+  const double segments = static_cast<double>( cwnd_ ) / static_cast<double>( mss_ );
+  w_max_ = segments < w_max_ ? segments * ( 1 + BETA ) / 2 : segments;
+  ssthresh_ = max( static_cast<uint64_t>( static_cast<double>( cwnd_ ) * BETA ), 2 * mss_ );
+  epoch_start_.reset();
+  bytes_acked_ = 0;
+}
+
+void Cubic::on_ack( uint64_t acked_bytes,
+                    uint64_t bytes_in_flight,
+                    uint64_t now_ms,
+                    optional<uint64_t> rtt_ms,
+                    optional<uint64_t> srtt_ms )
+{
+  if ( cwnd_ < ssthresh_ ) {
+    NewReno::on_ack( acked_bytes, bytes_in_flight, now_ms, rtt_ms, srtt_ms );
+    return;
+  }
+
+  const auto mss = static_cast<double>( mss_ );
+  if ( !epoch_start_.has_value() ) {
+    epoch_start_ = now_ms;
+    cwnd_segments_ = static_cast<double>( cwnd_ ) / mss;
+    w_est_ = cwnd_segments_;
+    if ( w_max_ <= cwnd_segments_ ) {
+      w_max_ = cwnd_segments_;
+      k_ = 0;
+    } else {
+      k_ = cbrt( ( w_max_ - cwnd_segments_ ) / C );
+    }
+  }
+
+  // where the cubic function will be one round trip from now, growing by at most half a window per round trip
+  const double t = static_cast<double>( now_ms - epoch_start_.value() + srtt_ms.value_or( 0 ) ) / 1000;
+  double target = clamp( C * pow( t - k_, 3 ) + w_max_, cwnd_segments_, 1.5 * cwnd_segments_ );
+
+  // ... but no slower than Reno would grow with the same average window
+  const double segments_acked = static_cast<double>( acked_bytes ) / mss;
+  w_est_ += 3 * ( 1 - BETA ) / ( 1 + BETA ) * segments_acked / cwnd_segments_;
+  target = max( target, w_est_ );
+
+  cwnd_segments_ += ( target - cwnd_segments_ ) / cwnd_segments_ * segments_acked;
+  cwnd_ = max( static_cast<uint64_t>( cwnd_segments_ * mss ), cwnd_ );
+}
+
+void Cubic::on_loss( uint64_t /* bytes_in_flight */, uint64_t /* now_ms */ )
+{
+  reduce();
+  cwnd_ = ssthresh_;
+}
+
+void Cubic::on_rto( uint64_t /* bytes_in_flight */, uint64_t /* now_ms */ )
+{
+  reduce();
+  cwnd_ = mss_;
+}
+
+BBR::BBR( uint64_t mss ) : mss_( mss ), cwnd_( 10 * mss ) {}
+
+uint64_t BBR::bdp() const
+{
+  if ( !min_rtt_ms_.has_value() ) {
+    return 0;
+  }
+  return static_cast<uint64_t>( btl_bw_ * static_cast<double>( min_rtt_ms_.value() ) );
+}
+
+uint64_t BBR::pacing_rate( optional<uint64_t> /* srtt_ms */ ) const
+{
+  return static_cast<uint64_t>( pacing_gain_ * btl_bw_ * 1000 );
+}
+
+// a round (about one minimum RTT) is over: take its delivery rate as a bandwidth sample
+void BBR::end_round( uint64_t now_ms )
+{
+  const auto elapsed = static_cast<double>( now_ms - round_start_ms_ );
+  bw_samples_[round_ % BW_WINDOW_ROUNDS] = static_cast<double>( delivered_ - round_start_delivered_ ) / elapsed;
+  ++round_;
+  btl_bw_ = *max_element( begin( bw_samples_ ), end( bw_samples_ ) );
+  round_start_ms_ = now_ms;
+  round_start_delivered_ = delivered_;
+
+  if ( mode_ == Mode::Startup ) {
+    if ( btl_bw_ >= full_bw_ * 1.25 ) {
+      full_bw_ = btl_bw_;
+      full_bw_rounds_ = 0;
+    } else {
+      ++full_bw_rounds_;
+    }
+  } else if ( mode_ == Mode::ProbeBW ) {
+    cycle_index_ = ( cycle_index_ + 1 ) % size( PROBE_GAINS );
+    pacing_gain_ = PROBE_GAINS[cycle_index_];
+  }
+}
+
+void BBR::update_mode( uint64_t bytes_in_flight )
+{
+  if ( mode_ == Mode::Startup && full_bw_rounds_ >= 3 ) {
+    mode_ = Mode::Drain;
+    pacing_gain_ = 1 / HIGH_GAIN;
+  }
+  if ( mode_ == Mode::Drain && bytes_in_flight <= bdp() ) {
+    mode_ = Mode::ProbeBW;
+    cwnd_gain_ = CWND_GAIN;
+    cycle_index_ = 0;
+    pacing_gain_ = PROBE_GAINS[cycle_index_];
+  }
+}
+
+void BBR::update_cwnd( uint64_t acked_bytes )
+{
+  const auto target = static_cast<uint64_t>( cwnd_gain_ * static_cast<double>( bdp() ) );
+  if ( mode_ != Mode::Startup ) {
+    cwnd_ = min( cwnd_ + acked_bytes, target );
+  } else if ( cwnd_ < target || target == 0 ) {
+    cwnd_ += acked_bytes;
+  }
+  cwnd_ = max( cwnd_, 4 * mss_ );
+}
+
+void BBR::on_ack( uint64_t acked_bytes,
+                  uint64_t bytes_in_flight,
+                  uint64_t now_ms,
+                  optional<uint64_t> rtt_ms,
+                  optional<uint64_t> /* srtt_ms */ )
+{
+  delivered_ += acked_bytes;
+  if ( rtt_ms.has_value() ) {
+    min_rtt_ms_ = min( min_rtt_ms_.value_or( UINT64_MAX ), max( rtt_ms.value(), uint64_t { 1 } ) );
+  }
+  if ( min_rtt_ms_.has_value() && now_ms - round_start_ms_ >= min_rtt_ms_.value() ) {
+    end_round( now_ms );
+  }
+  update_mode( bytes_in_flight );
+  update_cwnd( acked_bytes );
+}
+
+void BBR::on_loss( uint64_t /* bytes_in_flight */, uint64_t /* now_ms */ ) {}
+
+// start again from a minimal window, and grow back towards the model's target as data is acknowledged
+void BBR::on_rto( uint64_t /* bytes_in_flight */, uint64_t /* now_ms */ )
+{
+  cwnd_ = mss_;
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+// Which congestion controller a TCPSender consults (None: limited only by the receiver's window)
+enum class CongestionControl : uint8_t
+{
+  None,
+  NewReno,
+  Cubic,
+  BBR,
+};
+
+/*
+ * A congestion controller decides how many bytes may be in flight (the congestion window), and optionally
+ * how fast they should be sent. The TCPSender tells it about acknowledgments, losses and timeouts.
+ * All sizes are in bytes and all times in milliseconds, measured on the sender's clock.
+ */
+class CongestionController
+{
+public:
+  virtual ~CongestionController() = default;
+
+  virtual uint64_t cwnd() const = 0;
+  virtual uint64_t ssthresh() const = 0;
+  // Bytes per second (0: don't pace), given the sender's smoothed round-trip time (nullopt: no sample yet)
+  virtual uint64_t pacing_rate( std::optional<uint64_t> srtt_ms ) const = 0;
+
+  // New data was acknowledged. `rtt_ms` is a round-trip sample, if the acked data was never retransmitted, and
+  // `srtt_ms` is the sender's smoothed round-trip time (RFC 6298), including that sample.
+  virtual void on_ack( uint64_t acked_bytes,
+                       uint64_t bytes_in_flight,
+                       uint64_t now_ms,
+                       std::optional<uint64_t> rtt_ms,
+                       std::optional<uint64_t> srtt_ms )
+    = 0;
+
+  // A loss was detected without a timeout (e.g., by duplicate acknowledgments)
+  virtual void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+
+  // The retransmission timer expired
+  virtual void on_rto( uint64_t bytes_in_flight, uint64_t now_ms ) = 0;
+};
+
+// Make the controller for `algorithm` (nullptr for CongestionControl::None), for segments of up to `mss` bytes
+std::unique_ptr<CongestionController> make_congestion_controller( CongestionControl algorithm, uint64_t mss );
+
+// RFC 6582 NewReno: slow start, then one MSS per window of acknowledged data; halve on loss
+class NewReno : public CongestionController
+{
+protected:
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_ { UINT64_MAX };
+  uint64_t bytes_acked_ { 0 }; // in congestion avoidance, since cwnd last grew
+
+public:
+  explicit NewReno( uint64_t mss );
+
+  uint64_t cwnd() const override { return cwnd_; }
+  uint64_t ssthresh() const override { return ssthresh_; }
+  uint64_t pacing_rate( std::optional<uint64_t> srtt_ms ) const override;
+
+  void on_ack( uint64_t acked_bytes,
+               uint64_t bytes_in_flight,
+               uint64_t now_ms,
+               std::optional<uint64_t> rtt_ms,
+               std::optional<uint64_t> srtt_ms ) override;
+  void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_rto( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+};
+
+// RFC 9438 CUBIC: after a loss, the window follows a cubic function of the time since, centred on where the
+// loss happened, but never grows slower than Reno would
+class Cubic : public NewReno
+{
+  static constexpr double C = 0.4;
+  static constexpr double BETA = 0.7;
+
+  double w_max_ { 0 };                     // window (in segments) when the last loss happened
+  double k_ { 0 };                         // seconds it takes the cubic function to get back to w_max_
+  double w_est_ { 0 };                     // the window Reno would have had (in segments)
+  std::optional<uint64_t> epoch_start_ {}; // when the current congestion avoidance epoch began
+  double cwnd_segments_ { 0 };             // fractional window, in segments
+
+  void reduce();
+
+public:
+  explicit Cubic( uint64_t mss ) : NewReno( mss ) {}
+
+  void on_ack( uint64_t acked_bytes,
+               uint64_t bytes_in_flight,
+               uint64_t now_ms,
+               std::optional<uint64_t> rtt_ms,
+               std::optional<uint64_t> srtt_ms ) override;
+  void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_rto( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+};
+
+/*
+ * A simplified BBR (v1): estimate the bottleneck bandwidth (the highest recent delivery rate) and the minimum
+ * round-trip time, pace at a multiple of the bandwidth, and keep about two bandwidth-delay products in flight.
+ * Runs STARTUP until the bandwidth stops growing, DRAINs the queue that built up, then cycles the pacing gain
+ * in PROBE_BW. There is no PROBE_RTT phase, and losses don't shrink the window.
+ */
+class BBR : public CongestionController
+{
+  enum class Mode : uint8_t
+  {
+    Startup,
+    Drain,
+    ProbeBW,
+  };
+
+  static constexpr double HIGH_GAIN = 2.885; // 2/ln(2)
+  static constexpr double CWND_GAIN = 2.0;
+  static constexpr uint64_t BW_WINDOW_ROUNDS = 10;
+  static constexpr double PROBE_GAINS[] = { 1.25, 0.75, 1, 1, 1, 1, 1, 1 };
+
+  uint64_t mss_;
+  Mode mode_ { Mode::Startup };
+  double pacing_gain_ { HIGH_GAIN };
+  double cwnd_gain_ { HIGH_GAIN };
+  uint64_t cwnd_;
+
+  // delivery rate samples (bytes per ms), one per round, and the bandwidth estimate (their max)
+  double bw_samples_[BW_WINDOW_ROUNDS] {};
+  uint64_t round_ { 0 };
+  double btl_bw_ { 0 };
+  std::optional<uint64_t> min_rtt_ms_ {};
+
+  // the current round: delivery since it started
+  uint64_t delivered_ { 0 };
+  uint64_t round_start_delivered_ { 0 };
+  uint64_t round_start_ms_ { 0 };
+
+  // STARTUP ends once the bandwidth has grown less than 25% for three rounds
+  double full_bw_ { 0 };
+  uint64_t full_bw_rounds_ { 0 };
+
+  size_t cycle_index_ { 0 };
+
+  uint64_t bdp() const;
+  void end_round( uint64_t now_ms );
+  void update_mode( uint64_t bytes_in_flight );
+  void update_cwnd( uint64_t acked_bytes );
+
+public:
+  explicit BBR( uint64_t mss );
+
+  uint64_t cwnd() const override { return cwnd_; }
+  uint64_t ssthresh() const override { return UINT64_MAX; }
+  uint64_t pacing_rate( std::optional<uint64_t> srtt_ms ) const override;
+
+  void on_ack( uint64_t acked_bytes,
+               uint64_t bytes_in_flight,
+               uint64_t now_ms,
+               std::optional<uint64_t> rtt_ms,
+               std::optional<uint64_t> srtt_ms ) override;
+  void on_loss( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+  void on_rto( uint64_t bytes_in_flight, uint64_t now_ms ) override;
+};
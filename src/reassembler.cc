@@ -1,63 +1,65 @@
 #include "reassembler.hh"
 
+#include <algorithm>
+#include <iterator>
+
 using namespace std;
 
 void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring, Writer& output )
 {
-  if ( !has_init_ ) {
-    has_init_ = true;
-    cap_ = output.available_capacity();
-    buffer_ = string( cap_, 0 );
-    vis = vector<bool>( cap_, false );
-  }
-
   const auto data_len = static_cast<uint64_t>( data.size() );
-  auto cur_cap = output.available_capacity();
+  insert( first_index, Buffer( move( data ) ), 0, data_len, is_last_substring, output );
+}
+
+void Reassembler::insert( uint64_t first_index,
+                          const Buffer& data,
+                          uint64_t offset,
+                          uint64_t len,
+                          bool is_last_substring,
+                          Writer& output )
+{
+  const uint64_t data_len = min( len, data.size() - min( offset, static_cast<uint64_t>( data.size() ) ) );
+  const uint64_t data_end = first_index + data_len;
+  const uint64_t window_end = next_index_ + output.available_capacity();
 
   if ( is_last_substring ) {
-    last_index_ = static_cast<int64_t>( first_index + data_len );
+    last_index_ = static_cast<int64_t>( data_end );
   }
 
-  if ( first_index > next_index_ ) {
-    /**
-     * n_i     f_i
-     *   | delta |  data_len          |
-     *   |_______|____________________|
-     *   |  cur_cap             e_i
-     *   |________________________|
-     */
-    const uint64_t delta = first_index - next_index_;
-    const uint64_t buf_len = min( data_len, cur_cap - delta );
-    uint64_t buf_idx = ( buf_index_ + delta ) % cap_;
-    for ( uint64_t offset = 0; offset < buf_len; ++offset ) {
-      // do not count when overlap
-      if ( !vis[buf_idx] ) {
-        vis[buf_idx] = true;
-        bytes_pending_ += 1;
-        buffer_[buf_idx] = data[offset];
-      }
-      buf_idx = ( buf_idx + 1 ) % cap_;
-    }
-  } else if ( first_index <= next_index_ && next_index_ < first_index + data_len ) {
-    // data is cuurent next bytes
-    auto start = next_index_ - first_index;
-    auto substr_len = data_len - start;
-    substr_len = min( substr_len, cur_cap );
-    output.push( data.substr( start, substr_len ) );
-
-    // data may overlap current cache, clear pending bytes
-    cur_cap -= substr_len;
-    next_index_ += substr_len;
-    for ( uint64_t offset = 0; offset < substr_len; ++offset ) {
-      auto i = ( buf_index_ + offset ) % cap_;
-      if ( vis[i] ) {
-        vis[i] = false;
-        bytes_pending_ -= 1;
-      }
-    }
-    buf_index_ = ( buf_index_ + substr_len ) % cap_;
+  // bytes that were already written, and bytes that wouldn't fit even once the gaps are filled
+  duplicate_bytes_ += min( data_end, next_index_ ) - min( first_index, next_index_ );
+  dropped_bytes_ += data_end - min( data_end, max( first_index, window_end ) );
+
+  /**
+   * only the part of data inside the window can be kept
+   *
+   *   n_i         f_i                    e_i
+   *    | [  data   |  ...  ]              |
+   *    |__________________________________|
+   *                 window
+   */
+  const uint64_t begin = max( first_index, next_index_ );
+  const uint64_t end = min( data_end, window_end );
 
-    handle_contiguous_caches( cur_cap, output );
+  // the window may have shrunk since earlier bytes were stored
+  if ( !pending_.empty() ) {
+    discard_beyond( window_end );
+  }
+
+  if ( begin < end ) {
+    if ( first_index == next_index_ && pending_.empty() ) {
+      // fast path: the substring continues the stream and nothing is waiting, so hand it straight to the output
+      output.push( data.substr( offset, end - begin ) );
+      next_index_ = end;
+    } else {
+      const uint64_t stored_before = bytes_pending_;
+      store( begin, data.substr( offset + begin - first_index, end - begin ) );
+      overlapping_bytes_ += ( end - begin ) - ( bytes_pending_ - stored_before );
+
+      write_contiguous( output );
+      peak_pending_memory_ = max( peak_pending_memory_, pending_memory_ );
+      max_holes_ = max( max_holes_, holes() );
+    }
   }
 
   if ( last_index_ > -1 && next_index_ == static_cast<uint64_t>( last_index_ ) ) {
@@ -70,23 +72,137 @@ uint64_t Reassembler::bytes_pending() const
   return bytes_pending_;
 }
 
-// check whether there are subsequent bytes and if so, write output
-void Reassembler::handle_contiguous_caches( uint64_t cur_cap, Writer& output )
+vector<pair<uint64_t, uint64_t>> Reassembler::pending_ranges( size_t max_ranges ) const
+{
+  vector<pair<uint64_t, uint64_t>> ranges;
+  for ( const auto& [index, data] : pending_ ) {
+    if ( !ranges.empty() && ranges.back().second == index ) {
+      ranges.back().second += data.size();
+    } else if ( ranges.size() < max_ranges ) {
+      ranges.emplace_back( index, index + data.size() );
+    } else {
+      break;
+    }
+  }
+  return ranges;
+}
+
+uint64_t Reassembler::holes() const
+{
+  return static_cast<uint64_t>( holes_ );
+}
+
+// memory kept alive by one pending substring: its storage, plus the map node and the storage's own header
+uint64_t Reassembler::footprint( const Buffer& data )
+{
+  constexpr uint64_t tree_node = sizeof( decltype( pending_ )::value_type ) + 4 * sizeof( void* );
+  constexpr uint64_t shared_string = sizeof( string ) + 2 * sizeof( void* );
+  return data.storage_size() + tree_node + shared_string;
+}
+
+void Reassembler::add_pending( map<uint64_t, Buffer>::iterator hint, uint64_t first_index, Buffer data )
+{
+  // a small piece of a large packet shouldn't pin the whole packet: copy it out instead
+  if ( data.size() * 2 < data.storage_size() ) {
+    data = Buffer { string { string_view { data } } };
+  }
+  bytes_pending_ += data.size();
+  pending_memory_ += footprint( data );
+  const auto it = pending_.emplace_hint( hint, first_index, move( data ) );
+  holes_ += 1 - touching_neighbours( it );
+}
+
+void Reassembler::remove_pending( map<uint64_t, Buffer>::iterator it )
 {
-  if ( vis[buf_index_] && cur_cap > 0 ) {
-    string buf;
-    for ( uint64_t i = 0; i < cur_cap; ++i ) {
-      auto ii = ( i + buf_index_ ) % cap_;
-      if ( !vis[ii] ) {
-        break;
-      }
-      vis[ii] = false;
-      bytes_pending_ -= 1;
-      buf.push_back( buffer_[ii] );
+  bytes_pending_ -= it->second.size();
+  pending_memory_ -= footprint( it->second );
+  holes_ -= 1 - touching_neighbours( it );
+  pending_.erase( it );
+}
+
+// how many of the stored substrings on either side of `it` join up with it (so `it` doesn't start its own run)
+int64_t Reassembler::touching_neighbours( map<uint64_t, Buffer>::const_iterator it ) const
+{
+  int64_t touching = 0;
+  if ( it != pending_.begin() && prev( it )->first + prev( it )->second.size() == it->first ) {
+    ++touching;
+  }
+  if ( next( it ) != pending_.end() && next( it )->first == it->first + it->second.size() ) {
+    ++touching;
+  }
+  return touching;
+}
+
+// keep the parts of data that aren't already pending, without overlapping anything stored
+void Reassembler::store( uint64_t first_index, const Buffer& data )
+{
+  const uint64_t end = first_index + data.size();
+  uint64_t pos = first_index;
+
+  // common under reordering: data lands after everything stored, so there's nothing to search
+  if ( !pending_.empty() ) {
+    const auto& [last_index, last_data] = *pending_.rbegin();
+    if ( last_index + last_data.size() <= first_index ) {
+      add_pending( pending_.end(), first_index, data );
+      return;
+    }
+  }
+
+  // `it` is the first stored substring starting after pos; the one before it may cover the start of data
+  auto it = pending_.upper_bound( pos );
+  if ( it != pending_.begin() ) {
+    const auto& [prev_index, prev_data] = *prev( it );
+    pos = max( pos, prev_index + prev_data.size() );
+  }
+
+  while ( pos < end ) {
+    const uint64_t gap_end = it == pending_.end() ? end : min( end, it->first );
+    if ( pos < gap_end ) {
+      add_pending( it, pos, data.substr( pos - first_index, gap_end - pos ) );
+    }
+    if ( it == pending_.end() ) {
+      break;
+    }
+    pos = max( pos, it->first + it->second.size() );
+    ++it;
+  }
+}
+
+// drop stored bytes at or after end_index
+void Reassembler::discard_beyond( uint64_t end_index )
+{
+  while ( !pending_.empty() ) {
+    auto last = prev( pending_.end() );
+    const uint64_t last_end = last->first + last->second.size();
+    if ( last_end <= end_index ) {
+      return;
+    }
+    const uint64_t first_index = last->first;
+    const Buffer data = last->second;
+    dropped_bytes_ += last_end - max( first_index, end_index );
+    remove_pending( last );
+    if ( first_index < end_index ) {
+      add_pending( pending_.end(), first_index, data.substr( 0, end_index - first_index ) );
+      return;
     }
-    output.push( buf );
-    auto buf_len = buf.size();
-    next_index_ += buf_len;
-    buf_index_ = ( buf_index_ + buf_len ) % cap_;
   }
-}
\ No newline at end of file
+}
+
+// write out the stored substrings that continue the stream
+void Reassembler::write_contiguous( Writer& output )
+{
+  if ( pending_.empty() || pending_.begin()->first != next_index_ ) {
+    return;
+  }
+
+  // the whole first run goes out, so there's one fewer run (and no need to look at neighbours one by one)
+  --holes_;
+  while ( !pending_.empty() && pending_.begin()->first == next_index_ ) {
+    Buffer data = move( pending_.begin()->second );
+    next_index_ += data.size();
+    bytes_pending_ -= data.size();
+    pending_memory_ -= footprint( data );
+    pending_.erase( pending_.begin() );
+    output.push( move( data ) );
+  }
+}
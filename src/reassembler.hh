@@ -2,23 +2,37 @@
 
 #include "byte_stream.hh"
 
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 class Reassembler
 {
-  bool has_init_ { false };
-
   uint64_t next_index_ { 0 };
-  uint64_t buf_index_ { 0 };
   uint64_t bytes_pending_ { 0 };
   int64_t last_index_ { -1 };
 
-  std::size_t cap_ { 0 };
-  std::vector<bool> vis {};
-  std::string buffer_ {};
+  // Bytes that can't be written yet, as non-overlapping substrings keyed by the index of their first byte
+  std::map<uint64_t, Buffer> pending_ {};
+
+  uint64_t pending_memory_ { 0 };
+  uint64_t peak_pending_memory_ { 0 };
+
+  int64_t holes_ { 0 }; // runs of pending bytes, each preceded by a gap
+  uint64_t max_holes_ { 0 };
+  uint64_t duplicate_bytes_ { 0 };
+  uint64_t overlapping_bytes_ { 0 };
+  uint64_t dropped_bytes_ { 0 };
 
-  void handle_contiguous_caches( uint64_t cur_cap, Writer& output );
+  static uint64_t footprint( const Buffer& data );
+  void add_pending( std::map<uint64_t, Buffer>::iterator hint, uint64_t first_index, Buffer data );
+  void remove_pending( std::map<uint64_t, Buffer>::iterator it );
+  int64_t touching_neighbours( std::map<uint64_t, Buffer>::const_iterator it ) const;
+
+  void store( uint64_t first_index, const Buffer& data );
+  void discard_beyond( uint64_t end_index );
+  void write_contiguous( Writer& output );
 
 public:
   /*
@@ -43,6 +57,32 @@ public:
    */
   void insert( uint64_t first_index, std::string data, bool is_last_substring, Writer& output );
 
+  /*
+   * Same as above, for the substring `data.substr( offset, len )` (whose first byte has index `first_index`).
+   * Nothing is copied: the Reassembler holds on to slices of `data`, and hands them to the output as they are.
+   */
+  void insert( uint64_t first_index,
+               const Buffer& data,
+               uint64_t offset,
+               uint64_t len,
+               bool is_last_substring,
+               Writer& output );
+
   // How many bytes are stored in the Reassembler itself?
   uint64_t bytes_pending() const;
+
+  // The runs of stored bytes, as [first index, end index) pairs, lowest first (at most `max_ranges` of them)
+  std::vector<std::pair<uint64_t, uint64_t>> pending_ranges( size_t max_ranges ) const;
+
+  // Approximate memory (in bytes) held for pending data between calls to insert: the storage it keeps
+  // alive plus bookkeeping. Nothing is held while data arrives in order.
+  uint64_t pending_memory() const { return pending_memory_; }
+  uint64_t peak_pending_memory() const { return peak_pending_memory_; }
+
+  // Statistics on the substrings inserted so far:
+  uint64_t duplicate_bytes() const { return duplicate_bytes_; }     // already written to the output
+  uint64_t overlapping_bytes() const { return overlapping_bytes_; } // already pending
+  uint64_t dropped_bytes() const { return dropped_bytes_; }         // beyond the available capacity
+  uint64_t holes() const;                                          // gaps before pending bytes, right now
+  uint64_t max_holes() const { return max_holes_; }                 // ... and the most seen after any insert
 };
@@ -0,0 +1,36 @@
+#include "rtt_estimator.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+void RTTEstimator::add_sample( uint64_t rtt_ms )
+{
+  const auto r = static_cast<double>( rtt_ms );
+  if ( !has_sample_ ) {
+    srtt_ms_ = r;
+    rttvar_ms_ = r / 2;
+    has_sample_ = true;
+    return;
+  }
+  // the deviation is measured against the old smoothed RTT
+  rttvar_ms_ = ( 1 - BETA ) * rttvar_ms_ + BETA * abs( srtt_ms_ - r );
+  srtt_ms_ = ( 1 - ALPHA ) * srtt_ms_ + ALPHA * r;
+}
+
+optional<uint64_t> RTTEstimator::srtt_ms() const
+{
+  if ( !has_sample_ ) {
+    return nullopt;
+  }
+  return static_cast<uint64_t>( lround( srtt_ms_ ) );
+}
+
+optional<uint64_t> RTTEstimator::rto_ms() const
+{
+  if ( !has_sample_ ) {
+    return nullopt;
+  }
+  return static_cast<uint64_t>( ceil( srtt_ms_ + max( CLOCK_GRANULARITY_MS, K * rttvar_ms_ ) ) );
+}
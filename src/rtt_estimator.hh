@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+// Bounds on an adaptive retransmission timeout, in milliseconds
+struct RTOBounds
+{
+  uint64_t min_ms { 200 };   // as in Linux (RFC 6298 suggests a conservative 1 s)
+  uint64_t max_ms { 60000 }; // RFC 6298 allows at least 60 s
+};
+
+/*
+ * RFC 6298 round-trip time estimation: a smoothed RTT and its mean deviation, updated from each sample,
+ * from which the retransmission timeout follows. Samples must come from segments that were sent only once
+ * (Karn's algorithm); that is up to the caller.
+ */
+class RTTEstimator
+{
+  static constexpr double ALPHA = 1.0 / 8;
+  static constexpr double BETA = 1.0 / 4;
+  static constexpr double K = 4;
+  static constexpr double CLOCK_GRANULARITY_MS = 1;
+
+  double srtt_ms_ { 0 };
+  double rttvar_ms_ { 0 };
+  bool has_sample_ { false };
+
+public:
+  void add_sample( uint64_t rtt_ms );
+
+  // Smoothed round-trip time (nullopt before the first sample)
+  std::optional<uint64_t> srtt_ms() const;
+
+  // Retransmission timeout the estimate implies, unclamped (nullopt before the first sample)
+  std::optional<uint64_t> rto_ms() const;
+};
@@ -26,7 +26,8 @@ void TCPReceiver::receive( TCPSenderMessage message, Reassembler& reassembler, W
   }
   auto absolute = seqno.unwrap( isn_.value(), inbound_stream.bytes_pushed() );
   if ( absolute > 0 ) {
-    reassembler.insert( absolute - 1, message.payload, is_last_substring, inbound_stream );
+    reassembler.insert(
+      absolute - 1, message.payload, 0, message.payload.size(), is_last_substring, inbound_stream );
   }
   send( inbound_stream );
 }
@@ -44,3 +45,16 @@ TCPReceiverMessage TCPReceiver::send( const Writer& inbound_stream ) const
   }
   return { Wrap32::wrap( absolute_seqno, isn_.value() ), window_size };
 }
+
+TCPReceiverMessage TCPReceiver::send( const Writer& inbound_stream, const Reassembler& reassembler ) const
+{
+  auto msg = send( inbound_stream );
+  if ( !isn_.has_value() ) {
+    return msg;
+  }
+  // stream index i is sequence number i + 1 (after the SYN)
+  for ( const auto& [first, end] : reassembler.pending_ranges( TCPReceiverMessage::MAX_SACK_BLOCKS ) ) {
+    msg.sack_blocks.push_back( { Wrap32::wrap( first + 1, isn_.value() ), Wrap32::wrap( end + 1, isn_.value() ) } );
+  }
+  return msg;
+}
@@ -17,4 +17,7 @@ public:
 
   /* The TCPReceiver sends TCPReceiverMessages back to the TCPSender. */
   TCPReceiverMessage send( const Writer& inbound_stream ) const;
+
+  /* Same, also reporting what the Reassembler holds beyond the ackno as SACK blocks. */
+  TCPReceiverMessage send( const Writer& inbound_stream, const Reassembler& reassembler ) const;
 };
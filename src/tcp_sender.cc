@@ -1,17 +1,49 @@
 #include "tcp_sender.hh"
 #include "tcp_config.hh"
 
+#include <algorithm>
 #include <random>
 
 using namespace std;
 
 /* TCPSender constructor (uses a random ISN if none given) */
-TCPSender::TCPSender( uint64_t initial_RTO_ms, optional<Wrap32> fixed_isn )
-  : isn_( fixed_isn.value_or( Wrap32 { random_device()() } ) )
-  , initial_RTO_ms_( initial_RTO_ms )
-  , RTO_timeout_( initial_RTO_ms )
+TCPSender::TCPSender( const TCPConfig& config )
+  : isn_( config.fixed_isn.value_or( Wrap32 { random_device()() } ) )
+  , initial_RTO_ms_( config.rt_timeout )
+  , RTO_timeout_( config.rt_timeout )
+  , adaptive_rto_( config.adaptive_rto )
+  , congestion_control_( config.congestion_control )
+  , congestion_( make_congestion_controller( config.congestion_control, config.mss ) )
+  , MSS_( config.mss )
+  , super_segments_( config.super_segments )
+  , fast_retransmit_( config.fast_retransmit )
+  , pacing_( config.pacing )
 {}
 
+// the congestion controller counts in MSS, so it starts over with the new one (before any data has been sent)
+void TCPSender::set_MSS( uint64_t MSS )
+{
+  // an MSS of zero would leave no room for payload; keep the one we have
+  if ( MSS == 0 || MSS == MSS_ ) {
+    return;
+  }
+  MSS_ = MSS;
+  congestion_ = make_congestion_controller( congestion_control_, MSS_ );
+}
+
+uint64_t TCPSender::MSS() const
+{
+  return MSS_;
+}
+
+uint64_t TCPSender::max_payload_size() const
+{
+  if ( super_segments_ ) {
+    return max( MSS_, TCPConfig::MAX_SUPER_SEGMENT_SIZE / MSS_ * MSS_ );
+  }
+  return MSS_;
+}
+
 uint64_t TCPSender::sequence_numbers_in_flight() const
 {
   return bytes_in_flight_;
@@ -22,70 +54,161 @@ uint64_t TCPSender::consecutive_retransmissions() const
   return consecutive_retransmission_;
 }
 
-optional<TCPSenderMessage> TCPSender::maybe_send()
+uint64_t TCPSender::congestion_window() const
+{
+  return congestion_ ? congestion_->cwnd() : UINT64_MAX;
+}
+
+uint64_t TCPSender::slow_start_threshold() const
 {
-  if ( !msg_queue_.empty() ) {
-    auto msg = std::move( msg_queue_.front() );
-    msg_queue_.pop();
-    return msg;
+  return congestion_ ? congestion_->ssthresh() : UINT64_MAX;
+}
+
+// the congestion controller's rate, or else a receiver's window per smoothed round trip
+uint64_t TCPSender::pacing_rate() const
+{
+  if ( congestion_ ) {
+    return congestion_->pacing_rate( rtt_.srtt_ms() );
   }
-  return std::nullopt;
+  const uint64_t srtt = rtt_.srtt_ms().value_or( 0 );
+  return srtt == 0 ? 0 : receiver_window_size_ * 1000 / srtt;
 }
 
-bool TCPSender::is_window_not_full( uint64_t window_size )
+uint64_t TCPSender::smoothed_RTT_ms() const
 {
-  return window_size > bytes_in_flight_;
+  return rtt_.srtt_ms().value_or( 0 );
 }
 
-void TCPSender::fill_window( Reader& outbound_stream )
+uint64_t TCPSender::current_RTO_ms() const
 {
-  if ( end_ ) {
-    return;
+  return RTO_timeout_;
+}
+
+uint64_t TCPSender::fast_retransmissions() const
+{
+  return fast_retransmissions_;
+}
+
+uint64_t TCPSender::timeout_retransmissions() const
+{
+  return timeout_retransmissions_;
+}
+
+uint64_t TCPSender::base_RTO() const
+{
+  if ( !adaptive_rto_.has_value() || !rtt_.rto_ms().has_value() ) {
+    return initial_RTO_ms_;
   }
+  return clamp( rtt_.rto_ms().value(), adaptive_rto_->min_ms, adaptive_rto_->max_ms );
+}
 
-  TCPSenderMessage msg {};
-  uint64_t window_size = receiver_window_size_ == 0 ? 1 : receiver_window_size_;
+optional<TCPSenderMessage> TCPSender::maybe_send()
+{
+  while ( !retransmit_queue_.empty() || !msg_queue_.empty() ) {
+    // retransmissions first, so that loss recovery doesn't wait behind a window of new data in the pacer
+    RingQueue<uint64_t>& queue = retransmit_queue_.empty() ? msg_queue_ : retransmit_queue_;
+    const uint64_t seqno = queue.front();
+
+    // the stored segment starting at this seqno, unless it has been acknowledged in the meantime
+    const size_t i = first_outstanding_from( seqno );
+    if ( i == outstanding_.size() || outstanding_[i].seqno != seqno ) {
+      queue.pop_front();
+      continue;
+    }
+    if ( pacing_ && tick_ * 1000 < next_send_us_ ) {
+      return std::nullopt;
+    }
+    queue.pop_front();
+    pace( outstanding_[i].msg.sequence_length() );
 
-  if ( next_seqno_ == 0 ) {
-    msg.SYN = true;
+    // time the segment, and run the timer, from when it actually leaves rather than when it was cut
+    if ( !outstanding_[i].sent_at_ms.has_value() ) {
+      outstanding_[i].sent_at_ms = tick_;
+    }
+    if ( !retransmission_timer_.has_value() ) {
+      retransmission_timer_ = tick_;
+    }
+    return outstanding_[i].msg; // shares the payload with the stored segment
   }
-  msg.seqno = Wrap32::wrap( next_seqno_, isn_ );
+  return std::nullopt;
+}
 
-  uint64_t length = std::min( std::min( window_size - bytes_in_flight_, outbound_stream.bytes_buffered() ),
-                              TCPConfig::MAX_PAYLOAD_SIZE );
-  if ( length > 0 ) {
-    auto payload = outbound_stream.peek();
-    msg.payload = Buffer( string( payload.substr( 0, length ) ) );
-    outbound_stream.pop( length );
+optional<uint64_t> TCPSender::next_send_time() const
+{
+  if ( retransmit_queue_.empty() && msg_queue_.empty() ) {
+    return std::nullopt;
   }
-  if ( outbound_stream.is_finished() && msg.sequence_length() + bytes_in_flight_ < window_size ) {
-    msg.FIN = true;
-    end_ = true;
+  const uint64_t now_us = tick_ * 1000;
+  if ( !pacing_ || next_send_us_ <= now_us ) {
+    return 0;
   }
+  return ( next_send_us_ - now_us + 999 ) / 1000;
+}
 
-  // ignore empty message
-  if ( msg.sequence_length() == 0 ) {
+// hold the next segment back for as long as this one takes to send at the pacing rate (sending
+// nothing earns no credit for a later burst)
+void TCPSender::pace( uint64_t sequence_length )
+{
+  const uint64_t rate = pacing_rate();
+  if ( !pacing_ || rate == 0 ) {
     return;
   }
+  next_send_us_ = max( next_send_us_, tick_ * 1000 ) + sequence_length * 1000000 / rate;
+}
 
-  if ( outstanding_msg_queue_.empty() ) {
-    retransmission_timer_ = tick_;
+// the index of the first stored segment starting at or after `seqno`
+size_t TCPSender::first_outstanding_from( uint64_t seqno ) const
+{
+  size_t lo = 0;
+  size_t hi = outstanding_.size();
+  while ( lo < hi ) {
+    const size_t mid = lo + ( hi - lo ) / 2;
+    if ( outstanding_[mid].seqno < seqno ) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
   }
+  return lo;
+}
 
-  msg_queue_.push( msg );
-  outstanding_msg_queue_.push( msg );
+// cut up to `max_segments` segments from the outbound stream, as far as the window allows, building each one
+// in its slot in the retransmission store
+uint64_t TCPSender::push( Reader& outbound_stream, uint64_t max_segments )
+{
+  uint64_t window_size = receiver_window_size_ == 0 ? 1 : receiver_window_size_;
+  if ( congestion_ ) {
+    window_size = min( window_size, congestion_->cwnd() );
+  }
 
-  next_seqno_ += msg.sequence_length();
-  bytes_in_flight_ += msg.sequence_length();
+  const uint64_t max_payload = max_payload_size();
+  uint64_t segments = 0;
+  while ( segments < max_segments && !end_ && window_size > bytes_in_flight_ ) {
+    const bool syn = next_seqno_ == 0;
+    const uint64_t length
+      = min( { window_size - bytes_in_flight_, outbound_stream.bytes_buffered(), max_payload } );
+    Buffer payload;
+    if ( length > 0 ) {
+      payload = outbound_stream.peek_buffer( length );
+      outbound_stream.pop( length );
+    }
+    const bool fin = outbound_stream.is_finished() && syn + length + bytes_in_flight_ < window_size;
 
-  if ( is_window_not_full( window_size ) ) {
-    fill_window( outbound_stream );
-  }
-}
+    // nothing to send
+    if ( !syn && length == 0 && !fin ) {
+      break;
+    }
 
-void TCPSender::push( Reader& outbound_stream )
-{
-  fill_window( outbound_stream );
+    const auto& segment = outstanding_.push_back(
+      { next_seqno_, { Wrap32::wrap( next_seqno_, isn_ ), syn, std::move( payload ), fin } } );
+    msg_queue_.push_back( next_seqno_ );
+
+    end_ = fin;
+    next_seqno_ += segment.msg.sequence_length();
+    bytes_in_flight_ += segment.msg.sequence_length();
+    ++segments;
+  }
+  return segments;
 }
 
 TCPSenderMessage TCPSender::send_empty_message() const
@@ -105,45 +228,133 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
     // impossible case, we should ignore this.
     return;
   }
+  // RFC 5681: a duplicate acks nothing new and leaves the window alone, while data is outstanding
+  const bool duplicate = fast_retransmit_ && ackno == highest_ackno_ && msg.window_size == receiver_window_size_
+                         && !outstanding_.empty();
   // TODO: 这合理吗
   receiver_window_size_ = msg.window_size;
-  if ( outstanding_msg_queue_.empty() ) {
-    return;
+  apply_sack_blocks( msg );
+  if ( duplicate ) {
+    on_duplicate_ack();
   }
-  auto front_seqno = outstanding_msg_queue_.front().seqno.unwrap( isn_, next_seqno_ );
-  if ( front_seqno >= ackno ) {
+  if ( outstanding_.empty() || outstanding_.front().seqno >= ackno ) {
     return;
   }
+  if ( ackno > highest_ackno_ ) {
+    highest_ackno_ = ackno;
+    duplicate_acks_ = 0;
+  }
   // pop all acked segments
-  while ( !outstanding_msg_queue_.empty() ) {
-    auto seqno = outstanding_msg_queue_.front().seqno.unwrap( isn_, next_seqno_ );
-    if ( seqno + outstanding_msg_queue_.front().sequence_length() <= ackno ) {
-      // printf( "%lu %lu\n", bytes_in_flight_, outstanding_msg_queue_.front().sequence_length() );
-      bytes_in_flight_ -= outstanding_msg_queue_.front().sequence_length();
-      outstanding_msg_queue_.pop();
+  uint64_t acked_bytes = 0;
+  optional<uint64_t> rtt_sample;
+  while ( !outstanding_.empty() ) {
+    const auto& [seqno, segment, sent_at_ms, retransmitted, sacked] = outstanding_.front();
+    if ( seqno + segment.sequence_length() <= ackno ) {
+      bytes_in_flight_ -= segment.sequence_length();
+      acked_bytes += segment.payload.size();
+      if ( !retransmitted && sent_at_ms.has_value() ) {
+        // Karn's algorithm: only time segments that were sent once
+        rtt_sample = tick_ - sent_at_ms.value();
+      }
+      outstanding_.pop_front();
     } else {
       break;
     }
   }
+  if ( rtt_sample.has_value() ) {
+    rtt_.add_sample( rtt_sample.value() );
+  }
+  if ( congestion_ && ( acked_bytes > 0 || rtt_sample.has_value() ) ) {
+    congestion_->on_ack( acked_bytes, bytes_in_flight_, tick_, rtt_sample, rtt_.srtt_ms() );
+  }
+  if ( recovery_point_.has_value() ) {
+    if ( ackno >= recovery_point_.value() ) {
+      recovery_point_.reset();
+    } else if ( !outstanding_.empty() ) {
+      // a partial acknowledgment: the next segment was lost too
+      fast_retransmit();
+    }
+  }
   // reset timer
   consecutive_retransmission_ = 0;
-  RTO_timeout_ = initial_RTO_ms_;
-  if ( !outstanding_msg_queue_.empty() ) {
+  RTO_timeout_ = base_RTO();
+  if ( !outstanding_.empty() && outstanding_.front().sent_at_ms.has_value() ) {
     retransmission_timer_ = tick_;
   } else {
     retransmission_timer_ = std::nullopt;
   }
 }
 
+// mark the stored segments the receiver holds in full, so they won't be retransmitted
+void TCPSender::apply_sack_blocks( const TCPReceiverMessage& msg )
+{
+  for ( const auto& block : msg.sack_blocks ) {
+    const uint64_t left = block.left.unwrap( isn_, next_seqno_ );
+    const uint64_t right = block.right.unwrap( isn_, next_seqno_ );
+    if ( left >= right || right > next_seqno_ ) {
+      continue;
+    }
+    highest_sacked_ = max( highest_sacked_, right );
+    for ( size_t i = first_outstanding_from( left );
+          i < outstanding_.size() && outstanding_[i].seqno + outstanding_[i].msg.sequence_length() <= right;
+          ++i ) {
+      outstanding_[i].sacked = true;
+    }
+  }
+}
+
+// resend the oldest segment, and every other one that the receiver is known to be missing (below a SACK block)
+void TCPSender::retransmit_holes()
+{
+  retransmit_queue_.push_back( outstanding_.front().seqno );
+  outstanding_.front().retransmitted = true;
+  for ( size_t i = 1; i < outstanding_.size() && outstanding_[i].seqno < highest_sacked_; ++i ) {
+    if ( !outstanding_[i].sacked ) {
+      retransmit_queue_.push_back( outstanding_[i].seqno );
+      outstanding_[i].retransmitted = true;
+    }
+  }
+}
+
+// the third duplicate starts recovery, resending the oldest segment without waiting for the timer
+void TCPSender::on_duplicate_ack()
+{
+  if ( ++duplicate_acks_ != DUPLICATE_ACK_THRESHOLD || recovery_point_.has_value() ) {
+    return;
+  }
+  recovery_point_ = next_seqno_;
+  if ( congestion_ ) {
+    congestion_->on_loss( bytes_in_flight_, tick_ );
+  }
+  fast_retransmit();
+  retransmission_timer_ = tick_;
+}
+
+void TCPSender::fast_retransmit()
+{
+  retransmit_queue_.push_back( outstanding_.front().seqno );
+  outstanding_.front().retransmitted = true;
+  ++fast_retransmissions_;
+}
+
 void TCPSender::tick( const size_t ms_since_last_tick )
 {
   tick_ += ms_since_last_tick;
-  if ( !outstanding_msg_queue_.empty() && tick_ - retransmission_timer_.value() >= RTO_timeout_ ) {
-    msg_queue_.push( outstanding_msg_queue_.front() );
+  if ( retransmission_timer_.has_value() && tick_ - retransmission_timer_.value() >= RTO_timeout_ ) {
+    retransmit_holes();
+    ++timeout_retransmissions_;
+    recovery_point_.reset();
+    duplicate_acks_ = 0;
 
     // 见文档中限制条件
     if ( receiver_window_size_ > 0 ) {
+      if ( congestion_ ) {
+        congestion_->on_rto( bytes_in_flight_, tick_ );
+      }
       RTO_timeout_ *= 2;
+      if ( adaptive_rto_.has_value() ) {
+        RTO_timeout_ = min( RTO_timeout_, max( adaptive_rto_->max_ms, base_RTO() ) );
+      }
       consecutive_retransmission_ += 1;
     }
     retransmission_timer_ = tick_;
@@ -1,18 +1,33 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "ring_queue.hh"
+#include "rtt_estimator.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
-#include <queue>
+#include <memory>
 
 class TCPSender
 {
   Wrap32 isn_;
   uint64_t initial_RTO_ms_;
 
+  // A segment that has been cut from the stream but not yet acknowledged, with its absolute sequence number
+  struct OutstandingSegment
+  {
+    uint64_t seqno {};
+    TCPSenderMessage msg {};
+    std::optional<uint64_t> sent_at_ms {}; // nullopt: still waiting to be sent (e.g. held back by the pacer)
+    bool retransmitted {};
+    bool sacked {}; // the receiver reported holding all of it
+  };
+
   uint64_t next_seqno_ { 0 };
-  std::queue<TCPSenderMessage> msg_queue_ {};
-  std::queue<TCPSenderMessage> outstanding_msg_queue_ {};
+  RingQueue<OutstandingSegment> outstanding_ {}; // the retransmission store, in sequence number order
+  RingQueue<uint64_t> msg_queue_ {};             // absolute seqnos of stored segments waiting to be sent
+  RingQueue<uint64_t> retransmit_queue_ {};      // ... and of those to resend, which go ahead of new data
   bool end_ { false };
   uint64_t bytes_in_flight_ { 0 };
   // 初始化为1，否则 tick 里面 RTO_timeout_ 判断会出错
@@ -23,19 +38,58 @@ class TCPSender
   uint64_t RTO_timeout_;
   std::optional<uint64_t> retransmission_timer_ {};
 
-  void fill_window( Reader& outbound_stream );
-  bool is_window_not_full( uint64_t window_size );
+  RTTEstimator rtt_ {};
+  std::optional<RTOBounds> adaptive_rto_; // nullopt: the RTO starts over from initial_RTO_ms_ on every ack
+
+  uint64_t base_RTO() const; // the RTO before any backoff
+
+  CongestionControl congestion_control_;
+  std::unique_ptr<CongestionController> congestion_; // nullptr: limited only by the receiver's window
+
+  uint64_t MSS_;
+  bool super_segments_; // segments carry as many whole MSS as fit in MAX_SUPER_SEGMENT_SIZE
+
+  uint64_t highest_sacked_ { 0 }; // end of the highest SACK block received
+
+  // fast retransmit and NewReno recovery (RFC 5681, RFC 6582)
+  static constexpr uint64_t DUPLICATE_ACK_THRESHOLD = 3;
+  bool fast_retransmit_;
+  uint64_t highest_ackno_ { 0 };
+  uint64_t duplicate_acks_ { 0 };
+  std::optional<uint64_t> recovery_point_ {}; // in recovery until everything sent before it is acknowledged
+  uint64_t fast_retransmissions_ { 0 };
+  uint64_t timeout_retransmissions_ { 0 };
+
+  // pacing: segments leave no earlier than next_send_us_ (in microseconds on the tick_ clock)
+  bool pacing_;
+  uint64_t next_send_us_ { 0 };
+
+  void pace( uint64_t sequence_length );
+
+  void apply_sack_blocks( const TCPReceiverMessage& msg );
+  void retransmit_holes();
+  void on_duplicate_ack();
+  void fast_retransmit();
+
+  size_t first_outstanding_from( uint64_t seqno ) const;
 
 public:
-  /* Construct TCP sender with given default Retransmission Timeout and possible ISN */
-  TCPSender( uint64_t initial_RTO_ms, std::optional<Wrap32> fixed_isn );
+  /* Construct TCP sender from the config's initial Retransmission Timeout, possible ISN, congestion controller,
+   * adaptive Retransmission Timeout bounds, fast retransmit, pacing, maximum segment size and super-segments */
+  explicit TCPSender( const TCPConfig& config );
+
+  /* Use a new maximum segment size (the one negotiated with the peer, during the handshake); 0 is ignored */
+  void set_MSS( uint64_t MSS );
 
-  /* Push bytes from the outbound stream */
-  void push( Reader& outbound_stream );
+  /* Push bytes from the outbound stream, as at most `max_segments` new segments (returns how many were made) */
+  uint64_t push( Reader& outbound_stream, uint64_t max_segments = UINT64_MAX );
 
-  /* Send a TCPSenderMessage if needed (or empty optional otherwise) */
+  /* Send a TCPSenderMessage if needed (or empty optional otherwise, including when pacing holds it back) */
   std::optional<TCPSenderMessage> maybe_send();
 
+  /* Milliseconds until maybe_send() will have a segment to send (0: now, empty optional: nothing is waiting) */
+  std::optional<uint64_t> next_send_time() const;
+
   /* Generate an empty TCPSenderMessage */
   TCPSenderMessage send_empty_message() const;
 
@@ -48,4 +102,13 @@ public:
   /* Accessors for use in testing */
   uint64_t sequence_numbers_in_flight() const;  // How many sequence numbers are outstanding?
   uint64_t consecutive_retransmissions() const; // How many consecutive *re*transmissions have happened?
+  uint64_t congestion_window() const;           // Congestion window in bytes (UINT64_MAX without a controller)
+  uint64_t slow_start_threshold() const;        // Slow start threshold in bytes (UINT64_MAX if none)
+  uint64_t pacing_rate() const;                 // Rate to pace at, in bytes per second (0: unpaced)
+  uint64_t smoothed_RTT_ms() const;             // Smoothed round-trip time (0: no sample yet)
+  uint64_t current_RTO_ms() const;              // Retransmission timeout currently in effect
+  uint64_t fast_retransmissions() const;        // Segments resent on duplicate or partial acknowledgments
+  uint64_t timeout_retransmissions() const;     // Times the retransmission timer expired
+  uint64_t MSS() const;                         // Largest payload of a datagram on the wire
+  uint64_t max_payload_size() const;            // Largest payload of a segment (several MSS for super-segments)
 };
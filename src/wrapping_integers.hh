@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <span>
 
 /*
  * The Wrap32 type represents a 32-bit unsigned integer that:
@@ -14,10 +16,13 @@ protected:
   uint32_t raw_value_ {};
 
 public:
-  explicit Wrap32( uint32_t raw_value ) : raw_value_( raw_value ) {}
+  explicit constexpr Wrap32( uint32_t raw_value ) : raw_value_( raw_value ) {}
 
   /* Construct a Wrap32 given an absolute sequence number n and the zero point. */
-  static Wrap32 wrap( uint64_t n, Wrap32 zero_point );
+  static constexpr Wrap32 wrap( uint64_t n, Wrap32 zero_point )
+  {
+    return Wrap32 { static_cast<uint32_t>( n ) + zero_point.raw_value_ };
+  }
 
   /*
    * The unwrap method returns an absolute sequence number that wraps to this Wrap32, given the zero point
@@ -26,8 +31,43 @@ public:
    * There are many possible absolute sequence numbers that all wrap to the same Wrap32.
    * The unwrap method should return the one that is closest to the checkpoint.
    */
-  uint64_t unwrap( Wrap32 zero_point, uint64_t checkpoint ) const;
+  constexpr uint64_t unwrap( Wrap32 zero_point, uint64_t checkpoint ) const
+  {
+    // how far this is ahead of the checkpoint, modulo 2^32
+    const uint32_t offset = raw_value_ - zero_point.raw_value_ - static_cast<uint32_t>( checkpoint );
+    const uint64_t up = checkpoint + offset;
 
-  Wrap32 operator+( uint32_t n ) const { return Wrap32 { raw_value_ + n }; }
-  bool operator==( const Wrap32& other ) const { return raw_value_ == other.raw_value_; }
+    // go back one wrap when that is at least as close (offset >= 2^31), unless it would go below zero
+    const uint64_t go_down = static_cast<uint64_t>( offset >> 31U ) & static_cast<uint64_t>( up >= ( 1UL << 32 ) );
+    return up - ( go_down << 32U );
+  }
+
+  /*
+   * Unwrap each of `seqnos` into the same position of `out` (which must be at least as long), all against the
+   * same zero point and checkpoint.
+   */
+  static constexpr void unwrap_batch( std::span<const Wrap32> seqnos,
+                                      Wrap32 zero_point,
+                                      uint64_t checkpoint,
+                                      std::span<uint64_t> out )
+  {
+    if ( checkpoint < ( 1UL << 32 ) ) {
+      // near zero, stepping back a wrap may not be possible
+      for ( size_t i = 0; i < seqnos.size(); ++i ) {
+        out[i] = seqnos[i].unwrap( zero_point, checkpoint );
+      }
+      return;
+    }
+
+    // otherwise it always is, which leaves only 32-bit arithmetic per element for the compiler to vectorize
+    const uint32_t base = zero_point.raw_value_ + static_cast<uint32_t>( checkpoint );
+    const uint64_t lowest = checkpoint - ( 1UL << 32 );
+    for ( size_t i = 0; i < seqnos.size(); ++i ) {
+      const uint32_t offset = seqnos[i].raw_value_ - base;
+      out[i] = lowest + ( offset ^ ( 1U << 31 ) ) + ( 1UL << 31 );
+    }
+  }
+
+  constexpr Wrap32 operator+( uint32_t n ) const { return Wrap32 { raw_value_ + n }; }
+  constexpr bool operator==( const Wrap32& other ) const { return raw_value_ == other.raw_value_; }
 };
@@ -0,0 +1,57 @@
+#include "allocation_counter.hh"
+
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+using namespace std;
+
+bool counting_allocations = false;
+size_t allocation_count = 0;
+size_t allocated_bytes = 0;
+
+// replacing the global allocation functions pairs malloc with free, which GCC can't see through
+#if defined( __GNUC__ ) && !defined( __clang__ )
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new( size_t size )
+{
+  if ( counting_allocations ) {
+    ++allocation_count;
+  }
+  if ( void* ptr = malloc( size ) ) { // NOLINT(*-no-malloc, *-owning-memory)
+    allocated_bytes += malloc_usable_size( ptr );
+    return ptr;
+  }
+  throw bad_alloc {};
+}
+
+void operator delete( void* ptr ) noexcept
+{
+  if ( ptr != nullptr ) {
+    allocated_bytes -= malloc_usable_size( ptr );
+  }
+  free( ptr ); // NOLINT(*-no-malloc, *-owning-memory)
+}
+
+void operator delete( void* ptr, size_t /* size */ ) noexcept
+{
+  operator delete( ptr );
+}
+
+// (the array forms too, which a sanitizer's runtime would otherwise provide without going through the above)
+void* operator new[]( size_t size )
+{
+  return operator new( size );
+}
+
+void operator delete[]( void* ptr ) noexcept
+{
+  operator delete( ptr );
+}
+
+void operator delete[]( void* ptr, size_t /* size */ ) noexcept
+{
+  operator delete( ptr );
+}
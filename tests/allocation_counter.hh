@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+
+// Heap allocations counted by the global operator new, which allocation_counter.cc replaces.
+// A test that uses these must link against the allocation_counter library.
+extern bool counting_allocations; // count allocations only while this is set
+extern size_t allocation_count;   // allocations made while counting
+extern size_t allocated_bytes;    // heap bytes allocated with operator new and not yet freed (always tracked)
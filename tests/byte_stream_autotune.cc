@@ -0,0 +1,79 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    for ( const auto storage : { ByteStream::Storage::Ring, ByteStream::Storage::Chunked } ) {
+      {
+        ByteStreamTestHarness test { "grow as the reader falls behind", 4, 32, storage };
+
+        test.execute( AvailableCapacity { 4 } );
+        test.execute( Push { "ab" } );
+        test.execute( AvailableCapacity { 2 } );
+
+        test.execute( Push { "c" } );
+        test.execute( AvailableCapacity { 5 } );
+
+        test.execute( Push { "defghij" } );
+        test.execute( BytesBuffered { 10 } );
+        test.execute( AvailableCapacity { 22 } );
+        test.execute( Peek { "abcdefghij" } );
+
+        test.execute( Push { string( 30, 'x' ) } );
+        test.execute( BytesPushed { 32 } );
+        test.execute( AvailableCapacity { 0 } );
+      }
+
+      {
+        ByteStreamTestHarness test { "shrink when idle", 4, 64, storage };
+
+        test.execute( Push { "0123456789" } );
+        test.execute( AvailableCapacity { 22 } );
+
+        test.execute( ShrinkIfEmpty {} );
+        test.execute( AvailableCapacity { 22 } );
+
+        test.execute( Pop { 3 } );
+        test.execute( Push { "abc" } );
+        test.execute( Pop { 7 } );
+        test.execute( Peek { "abc" } );
+        test.execute( Pop { 3 } );
+        test.execute( ShrinkIfEmpty {} );
+        test.execute( AvailableCapacity { 4 } );
+
+        test.execute( Push { "wxyz" } );
+        test.execute( Peek { "wxyz" } );
+      }
+    }
+
+    {
+      ReassemblerTestHarness test { "reassembler into a growing stream", 4, 64 };
+
+      test.execute( Insert { "cd", 2 } );
+      test.execute( BytesPending { 2 } );
+      test.execute( Insert { "ab", 0 } );
+      test.execute( BytesPushed { 4 } );
+      test.execute( AvailableCapacity { 4 } );
+
+      test.execute( Insert { "ghijklmn", 6 } );
+      test.execute( BytesPending { 2 } );
+      test.execute( Insert { "ef", 4 } );
+      test.execute( BytesPushed { 8 } );
+      test.execute( Insert { "ghijklmnop", 6 } );
+      test.execute( BytesPushed { 16 } );
+      test.execute( ReadAll { "abcdefghijklmnop" } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
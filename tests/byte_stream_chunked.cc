@@ -0,0 +1,84 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "chunked write-write-pop", 15, ByteStream::Storage::Chunked };
+
+      test.execute( PushMove { "cat" } );
+      test.execute( Push { "tac" } );
+
+      test.execute( BytesPushed { 6 } );
+      test.execute( AvailableCapacity { 9 } );
+      test.execute( BytesBuffered { 6 } );
+      test.execute( PeekOnce { "cat" } );
+      test.execute( Peek { "cattac" } );
+      test.execute( PeekBuffer { "cattac" } );
+      test.execute( PeekIovecs { { "cat", "tac" } } );
+
+      test.execute( Pop { 2 } );
+
+      test.execute( BytesPopped { 2 } );
+      test.execute( AvailableCapacity { 11 } );
+      test.execute( PeekOnce { "t" } );
+      test.execute( PeekBuffer { "t" } );
+      test.execute( PeekBuffer { "tta" } );
+
+      test.execute( Pop { 2 } );
+
+      test.execute( PeekOnce { "ac" } );
+      test.execute( Close {} );
+      test.execute( IsFinished { false } );
+      test.execute( Pop { 2 } );
+      test.execute( IsFinished { true } );
+      test.execute( AvailableCapacity { 15 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "chunked overwrite", 5, ByteStream::Storage::Chunked };
+
+      test.execute( PushMove { "abc" } );
+      test.execute( PushMove { "defgh" } );
+
+      test.execute( BytesPushed { 5 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Peek { "abcde" } );
+
+      test.execute( Pop { 4 } );
+      test.execute( PushMove { "ijklmn" } );
+
+      test.execute( BytesPushed { 9 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( PeekOnce { "e" } );
+      test.execute( Peek { "eijkl" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "ring peek_buffer across the wrap", 4 };
+
+      test.execute( Push { "abc" } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { "defg" } );
+
+      test.execute( PeekOnce { "d" } );
+      test.execute( PeekBuffer { "defg" } );
+      test.execute( PeekIovecs { { "d", "efg" } } );
+      test.execute( Peek { "defg" } );
+
+      test.execute( Pop { 1 } );
+      test.execute( PeekIovecs { { "efg" } } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
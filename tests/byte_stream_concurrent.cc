@@ -0,0 +1,133 @@
+#include "concurrent_byte_stream.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace std;
+
+// Builds without the test harness (ConcurrentByteStream can't be moved into one), so that it can also be
+// compiled on its own under ThreadSanitizer.
+
+static void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( "ConcurrentByteStream: " + what );
+  }
+}
+
+static char pattern( uint64_t index )
+{
+  return static_cast<char>( 'a' + ( index * 7 + index / 251 ) % 26 );
+}
+
+int main()
+{
+  try {
+    {
+      // the ring wraps around; peek() returns the bytes up to the end of the ring, then the rest
+      ConcurrentByteStream bs { 8 };
+      bs.push( "abcdef" );
+      expect( bs.available_capacity() == 2, "available_capacity after pushing 6 of 8" );
+      expect( bs.peek() == "abcdef", "peek before the wrap" );
+      bs.pop( 4 );
+      bs.push( "ghijkl" );
+      expect( bs.bytes_pushed() == 12 and bs.bytes_buffered() == 8, "push across the wrap point" );
+      expect( bs.available_capacity() == 0, "available_capacity of a full stream" );
+      expect( bs.peek() == "efgh", "peek up to the end of the ring" );
+      bs.pop( 4 );
+      expect( bs.peek() == "ijkl", "peek after popping across the wrap point" );
+      bs.pop( 3 );
+      bs.push( "mnopqrs" );
+      expect( bs.peek() == "lmnop", "peek of bytes that straddle the wrap point" );
+      bs.pop( 5 );
+      expect( bs.peek() == "qrs", "peek of the wrapped bytes" );
+      expect( bs.bytes_popped() == 16, "bytes_popped" );
+    }
+
+    {
+      // pushes beyond capacity are truncated, and pops beyond what is buffered are clamped
+      ConcurrentByteStream bs { 5 };
+      bs.push( "0123456789" );
+      expect( bs.bytes_pushed() == 5 and bs.available_capacity() == 0, "push beyond capacity" );
+      bs.push( "x" );
+      expect( bs.bytes_pushed() == 5, "push to a full stream" );
+      expect( bs.peek() == "01234", "the truncated push kept its prefix" );
+      bs.pop( 100 );
+      expect( bs.bytes_popped() == 5 and bs.bytes_buffered() == 0, "pop beyond what is buffered" );
+      expect( bs.peek().empty(), "peek of an empty stream" );
+    }
+
+    {
+      // a closed stream is finished once it has been fully popped
+      ConcurrentByteStream bs { 4 };
+      bs.push( "ab" );
+      expect( not bs.is_closed() and not bs.is_finished(), "open stream" );
+      bs.close();
+      expect( bs.is_closed() and not bs.is_finished(), "closed stream with bytes buffered" );
+      bs.pop( 1 );
+      expect( not bs.is_finished(), "closed stream with one byte buffered" );
+      bs.pop( 1 );
+      expect( bs.is_finished(), "closed, fully popped stream" );
+      expect( not bs.has_error(), "stream without error" );
+      bs.set_error();
+      expect( bs.has_error(), "stream after set_error" );
+    }
+
+    {
+      // one writer thread and one reader thread, with writes and reads of varying sizes
+      constexpr uint64_t total = 1 << 20;
+      ConcurrentByteStream bs { 4093 };
+
+      thread writer { [&] {
+        string data;
+        uint64_t pushed = 0;
+        while ( pushed < total ) {
+          const uint64_t len = min( total - pushed, 1 + pushed % 1500 );
+          data.clear();
+          for ( uint64_t i = pushed; i < pushed + len; ++i ) {
+            data.push_back( pattern( i ) );
+          }
+          const uint64_t before = bs.bytes_pushed();
+          bs.push( data );
+          pushed += bs.bytes_pushed() - before;
+          if ( bs.bytes_pushed() == before ) {
+            this_thread::yield();
+          }
+        }
+        bs.close();
+      } };
+
+      uint64_t popped = 0;
+      bool corrupted = false;
+      while ( not bs.is_finished() ) {
+        const string_view view = bs.peek();
+        if ( view.empty() ) {
+          this_thread::yield();
+          continue;
+        }
+        const auto len = min( static_cast<uint64_t>( view.size() ), 1 + popped % 997 );
+        for ( uint64_t i = 0; i < len; ++i ) {
+          corrupted |= view[i] != pattern( popped + i );
+        }
+        bs.pop( len );
+        popped += len;
+      }
+      writer.join();
+
+      expect( not corrupted, "the reader thread saw bytes other than those written" );
+      expect( popped == total and bs.bytes_popped() == total, "the reader thread saw every byte" );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,147 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+#include "exception.hh"
+#include "file_descriptor.hh"
+
+#include <array>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+struct ReadFromPipe : public Push
+{
+  using Push::Push;
+  std::string description() const override
+  {
+    return "read_into() from a pipe holding \"" + Printer::prettify( data_ ) + "\"";
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    array<int, 2> fds {};
+    CheckSystemCall( "pipe", ::pipe( fds.data() ) );
+    FileDescriptor read_end { fds[0] };
+    FileDescriptor write_end { fds[1] };
+    write_end.write( data_ );
+    write_end.close();
+    read_into( read_end, bs.writer() );
+  }
+};
+
+// Reserve room for the data and write it, but then commit more than was reserved
+struct OverCommit : public Push
+{
+  uint64_t commit_len_;
+
+  OverCommit( std::string data, uint64_t commit_len ) : Push( std::move( data ) ), commit_len_( commit_len ) {}
+  std::string description() const override
+  {
+    return "reserve and write "" + Printer::prettify( data_ ) + "", then commit " + to_string( commit_len_ );
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    size_t copied = 0;
+    for ( const auto region : bs.writer().reserve( data_.size() ) ) {
+      copied += data_.copy( region.data(), region.size(), copied );
+    }
+    bs.writer().commit( commit_len_ );
+  }
+};
+
+int main()
+{
+  try {
+    for ( const auto storage : { ByteStream::Storage::Ring, ByteStream::Storage::Chunked } ) {
+      {
+        ByteStreamTestHarness test { "reserve-commit", 15, storage };
+
+        test.execute( ReserveCommit { "cat" } );
+        test.execute( BytesPushed { 3 } );
+        test.execute( AvailableCapacity { 12 } );
+        test.execute( Peek { "cat" } );
+
+        test.execute( ReserveCommit { "tac" } );
+        test.execute( BytesPushed { 6 } );
+        test.execute( Peek { "cattac" } );
+      }
+
+      {
+        ByteStreamTestHarness test { "reserve-commit-overwrite", 5, storage };
+
+        test.execute( Push { "abc" } );
+        test.execute( Pop { 2 } );
+        test.execute( ReserveCommit { "defghij" } );
+
+        test.execute( BytesPushed { 7 } );
+        test.execute( AvailableCapacity { 0 } );
+        test.execute( Peek { "cdefg" } );
+      }
+
+      {
+        ByteStreamTestHarness test { "commit no more than was reserved", 15, storage };
+
+        test.execute( Push { "0123456789abcde" } );
+        test.execute( Pop { 15 } );
+        test.execute( OverCommit { "cat", 10 } );
+        test.execute( BytesPushed { 18 } );
+        test.execute( BytesBuffered { 3 } );
+        test.execute( Peek { "cat" } );
+
+        // a commit without a reservation publishes nothing
+        test.execute( OverCommit { "", 4 } );
+        test.execute( BytesPushed { 18 } );
+        test.execute( AvailableCapacity { 12 } );
+      }
+
+      {
+        ByteStreamTestHarness test { "read_into", 8, storage };
+
+        test.execute( Push { "abcdef" } );
+        test.execute( Pop { 4 } );
+        test.execute( ReadFromPipe { "0123456789" } );
+
+        test.execute( BytesPushed { 12 } );
+        test.execute( AvailableCapacity { 0 } );
+        test.execute( Peek { "ef012345" } );
+      }
+    }
+
+    {
+      // chunked reservations come from a reused pool, and never overwrite bytes a slice still refers to
+      ByteStream bs { 100000, ByteStream::Storage::Chunked };
+      auto reserve_and_commit = [&]( const string& data ) {
+        const auto regions = bs.writer().reserve( data.size() );
+        data.copy( regions.front().data(), data.size() );
+        bs.writer().commit( data.size() );
+        return regions.front().data();
+      };
+
+      const char* first = reserve_and_commit( "abcdefghij" );
+      Buffer held = bs.reader().peek_buffer( 10 );
+      bs.reader().pop( 10 );
+      reserve_and_commit( "vwxyz" );
+      if ( string_view( held ) != "abcdefghij" or bs.reader().peek() != "vwxyz" ) {
+        throw runtime_error( "a reservation overwrote bytes that were still referenced" );
+      }
+
+      held = {};
+      bs.reader().pop( 5 );
+      if ( reserve_and_commit( "12345" ) != first or bs.reader().peek() != "12345" ) {
+        throw runtime_error( "an unreferenced reserve pool was not reused" );
+      }
+
+      if ( bs.writer().reserve( 90000 ).front().size() > 65536 ) {
+        throw runtime_error( "a chunked reservation was larger than the reserve pool" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
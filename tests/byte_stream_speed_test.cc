@@ -1,4 +1,5 @@
 #include "byte_stream.hh"
+#include "concurrent_byte_stream.hh"
 
 #include <chrono>
 #include <cstddef>
@@ -7,6 +8,7 @@
 #include <iostream>
 #include <queue>
 #include <random>
+#include <thread>
 
 using namespace std;
 using namespace std::chrono;
@@ -15,7 +17,8 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
                  const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t write_size,  // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t read_size )  // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t read_size,   // NOLINT(bugprone-easily-swappable-parameters)
+                 const ByteStream::Storage storage = ByteStream::Storage::Ring )
 {
   // Generate the data to be written
   const string data = [&random_seed, &input_len] {
@@ -34,7 +37,7 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
     split_data.emplace( data.substr( i, write_size ) );
   }
 
-  ByteStream bs { capacity };
+  ByteStream bs { capacity, storage };
   string output_data;
   output_data.reserve( data.size() );
 
@@ -76,7 +79,8 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
   debug_output.open( "/dev/tty" );
 
   cout << "ByteStream with capacity=" << capacity << ", write_size=" << write_size << ", read_size=" << read_size
-       << " reached " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
+       << ( storage == ByteStream::Storage::MirroredRing ? ", mirrored" : "" ) << " reached " << fixed
+       << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
 
   debug_output << "             ByteStream throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
                << " Gbit/s\n";
@@ -86,9 +90,86 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
   }
 }
 
+void threaded_speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+                          const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                          const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                          const size_t write_size,  // NOLINT(bugprone-easily-swappable-parameters)
+                          const size_t read_size )  // NOLINT(bugprone-easily-swappable-parameters)
+{
+  // Generate the data to be written
+  const string data = [&random_seed, &input_len] {
+    default_random_engine rd { random_seed };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  ConcurrentByteStream bs { capacity };
+  string output_data;
+  output_data.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+
+  // The writer runs on its own thread; the reader runs on this one.
+  thread writer { [&] {
+    const string_view input { data };
+    size_t written = 0;
+    while ( written < input.size() ) {
+      const auto before = bs.bytes_pushed();
+      bs.push( input.substr( written, write_size ) );
+      written += bs.bytes_pushed() - before;
+      if ( bs.bytes_pushed() == before ) {
+        this_thread::yield();
+      }
+    }
+    bs.close();
+  } };
+
+  while ( not bs.is_finished() ) {
+    auto peeked = bs.peek().substr( 0, read_size );
+    if ( peeked.empty() ) {
+      this_thread::yield();
+      continue;
+    }
+    output_data += peeked;
+    bs.pop( peeked.size() );
+  }
+
+  writer.join();
+  const auto stop_time = steady_clock::now();
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  auto bytes_per_second = static_cast<double>( input_len ) / test_duration.count();
+  auto bits_per_second = 8 * bytes_per_second;
+  auto gigabits_per_second = bits_per_second / 1e9;
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "ConcurrentByteStream (two threads) with capacity=" << capacity << ", write_size=" << write_size
+       << ", read_size=" << read_size << " reached " << fixed << setprecision( 2 ) << gigabits_per_second
+       << " Gbit/s.\n";
+
+  debug_output << "  ConcurrentByteStream throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
+               << " Gbit/s\n";
+
+  if ( gigabits_per_second < 0.1 ) {
+    throw runtime_error( "ConcurrentByteStream did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
 void program_body()
 {
   speed_test( 1e7, 32768, 789, 1500, 128 );
+  speed_test( 1e7, 32768, 789, 1500, 128, ByteStream::Storage::MirroredRing );
+  threaded_speed_test( 1e7, 32768, 789, 1500, 128 );
 }
 
 int main()
@@ -0,0 +1,72 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    for ( const auto storage : { ByteStream::Storage::MappedRing,
+                                 ByteStream::Storage::HugePageRing,
+                                 ByteStream::Storage::MirroredRing } ) {
+      const bool mirrored = storage == ByteStream::Storage::MirroredRing;
+
+      {
+        ByteStreamTestHarness test { "mapped write-pop-write across the wrap", 4096, storage };
+
+        test.execute( Push { string( 4000, 'a' ) } );
+        test.execute( Pop { 3990 } );
+        test.execute( Push { string( 200, 'b' ) } );
+
+        test.execute( BytesBuffered { 210 } );
+        test.execute( AvailableCapacity { 3886 } );
+        test.execute( PeekBuffer { string( 10, 'a' ) + string( 200, 'b' ) } );
+        test.execute( Peek { string( 10, 'a' ) + string( 200, 'b' ) } );
+        if ( mirrored ) {
+          test.execute( PeekOnce { string( 10, 'a' ) + string( 200, 'b' ) } );
+          test.execute( PeekIovecs { { string( 10, 'a' ) + string( 200, 'b' ) } } );
+        } else {
+          test.execute( PeekOnce { string( 10, 'a' ) + string( 96, 'b' ) } );
+          test.execute( PeekIovecs { { string( 10, 'a' ) + string( 96, 'b' ), string( 104, 'b' ) } } );
+        }
+
+        test.execute( Pop { 100 } );
+        test.execute( ReserveCommit { string( 3000, 'c' ) } );
+        test.execute( BytesBuffered { 3110 } );
+        test.execute( Peek { string( 110, 'b' ) + string( 3000, 'c' ) } );
+      }
+
+      {
+        // capacity isn't a whole number of pages, but the stream still holds exactly `capacity` bytes
+        ByteStreamTestHarness test { "mapped capacity", 10, storage };
+
+        test.execute( Push { "0123456789abc" } );
+        test.execute( BytesPushed { 10 } );
+        test.execute( AvailableCapacity { 0 } );
+        test.execute( Pop { 5 } );
+        test.execute( Push { "defghi" } );
+        test.execute( BytesPushed { 15 } );
+        test.execute( Peek { "56789defgh" } );
+      }
+
+      {
+        ByteStreamTestHarness test { "mapped autotune", 4096, 65536, storage };
+
+        test.execute( Push { string( 4000, 'a' ) } );
+        test.execute( Pop { 3000 } );
+        test.execute( Push { string( 5000, 'b' ) } );
+        test.execute( BytesBuffered { 6000 } );
+        test.execute( AvailableCapacity { 10384 } );
+        test.execute( Peek { string( 1000, 'a' ) + string( 5000, 'b' ) } );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
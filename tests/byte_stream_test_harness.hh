@@ -3,9 +3,11 @@
 #include "byte_stream.hh"
 #include "common.hh"
 
+#include <algorithm>
 #include <concepts>
 #include <optional>
 #include <utility>
+#include <vector>
 
 static_assert( sizeof( Reader ) == sizeof( ByteStream ),
                "Please add member variables to the ByteStream base, not the ByteStream Reader." );
@@ -16,8 +18,23 @@ static_assert( sizeof( Writer ) == sizeof( ByteStream ),
 class ByteStreamTestHarness : public TestHarness<ByteStream>
 {
 public:
-  ByteStreamTestHarness( std::string test_name, uint64_t capacity )
-    : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity } )
+  ByteStreamTestHarness( std::string test_name,
+                         uint64_t capacity,
+                         ByteStream::Storage storage = ByteStream::Storage::Ring )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( capacity )
+                     + ( storage == ByteStream::Storage::Chunked ? ", chunked" : "" ),
+                   ByteStream { capacity, storage } )
+  {}
+
+  ByteStreamTestHarness( std::string test_name,
+                         uint64_t initial_capacity,
+                         uint64_t max_capacity,
+                         ByteStream::Storage storage = ByteStream::Storage::Ring )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( initial_capacity ) + ".." + std::to_string( max_capacity )
+                     + ( storage == ByteStream::Storage::Chunked ? ", chunked" : "" ),
+                   ByteStream { initial_capacity, max_capacity, storage } )
   {}
 
   size_t peek_size() { return object().reader().peek().size(); }
@@ -34,6 +51,39 @@ struct Push : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.writer().push( data_ ); }
 };
 
+struct PushMove : public Push
+{
+  using Push::Push;
+  std::string description() const override
+  {
+    return "push \"" + Printer::prettify( data_ ) + "\" to the stream by move";
+  }
+  void execute( ByteStream& bs ) const override { bs.writer().push( std::string { data_ } ); }
+};
+
+struct ReserveCommit : public Push
+{
+  using Push::Push;
+  std::string description() const override
+  {
+    return "reserve and commit \"" + Printer::prettify( data_ ) + "\"";
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    size_t copied = 0;
+    for ( const auto region : bs.writer().reserve( data_.size() ) ) {
+      copied += data_.copy( region.data(), region.size(), copied );
+    }
+    bs.writer().commit( copied );
+  }
+};
+
+struct ShrinkIfEmpty : public Action<ByteStream>
+{
+  std::string description() const override { return "shrink_if_empty"; }
+  void execute( ByteStream& bs ) const override { bs.shrink_if_empty(); }
+};
+
 struct Close : public Action<ByteStream>
 {
   std::string description() const override { return "close"; }
@@ -107,6 +157,51 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekBuffer : public Peek
+{
+  using Peek::Peek;
+
+  std::string description() const override
+  {
+    return "peek_buffer() gives \"" + Printer::prettify( output_ ) + "\"";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    const Buffer peeked = bs.reader().peek_buffer( output_.size() );
+    if ( std::string_view( peeked ) != output_ ) {
+      throw ExpectationViolation { "Expected \"" + Printer::prettify( output_ ) + "\" from peek_buffer(), "
+                                   + "but found \"" + Printer::prettify( peeked ) + "\"" };
+    }
+  }
+};
+
+struct PeekIovecs : public Expectation<ByteStream>
+{
+  std::vector<std::string> output_;
+
+  explicit PeekIovecs( std::vector<std::string> output ) : output_( move( output ) ) {}
+
+  std::string description() const override
+  {
+    std::string ret = "peek_iovecs() gives {";
+    for ( const auto& x : output_ ) {
+      ret += " \"" + Printer::prettify( x ) + "\"";
+    }
+    return ret + " }";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    const auto peeked = bs.reader().peek_iovecs();
+    if ( peeked.size() != output_.size() or not std::equal( peeked.begin(), peeked.end(), output_.begin() ) ) {
+      throw ExpectationViolation { "peek_iovecs() returned " + std::to_string( peeked.size() )
+                                   + " regions that differ from the " + std::to_string( output_.size() )
+                                   + " expected" };
+    }
+  }
+};
+
 struct IsClosed : public ExpectBool<ByteStream>
 {
   using ExpectBool::ExpectBool;
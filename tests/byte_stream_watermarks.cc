@@ -0,0 +1,108 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+struct WatchReadable : public Action<ByteStream>
+{
+  uint64_t low_water_;
+  shared_ptr<uint64_t> count_;
+
+  WatchReadable( uint64_t low_water, shared_ptr<uint64_t> count )
+    : low_water_( low_water ), count_( move( count ) )
+  {}
+  std::string description() const override
+  {
+    return "count readable notifications at low-water mark " + to_string( low_water_ );
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    bs.set_readable_callback( low_water_, [count = count_] { ++*count; } );
+  }
+};
+
+struct WatchWritable : public WatchReadable
+{
+  using WatchReadable::WatchReadable;
+  std::string description() const override
+  {
+    return "count writable notifications at high-water mark " + to_string( low_water_ );
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    bs.set_writable_callback( low_water_, [count = count_] { ++*count; } );
+  }
+};
+
+struct Notifications : public ExpectNumber<ByteStream, uint64_t>
+{
+  shared_ptr<uint64_t> count_;
+
+  Notifications( uint64_t num, shared_ptr<uint64_t> count ) : ExpectNumber( num ), count_( move( count ) ) {}
+  std::string name() const override { return "[notifications]"; }
+  uint64_t value( ByteStream& /* bs */ ) const override { return *count_; }
+};
+
+int main()
+{
+  try {
+    for ( const auto storage : { ByteStream::Storage::Ring, ByteStream::Storage::Chunked } ) {
+      {
+        ByteStreamTestHarness test { "readable low-water mark", 15, storage };
+        auto count = make_shared<uint64_t>( 0 );
+
+        test.execute( WatchReadable { 4, count } );
+        test.execute( Push { "cat" } );
+        test.execute( Notifications { 0, count } );
+
+        test.execute( Push { "s" } );
+        test.execute( Notifications { 1, count } );
+
+        test.execute( Push { "dogs" } );
+        test.execute( Notifications { 1, count } );
+
+        test.execute( Pop { 8 } );
+        test.execute( Push { "ox" } );
+        test.execute( Notifications { 1, count } );
+
+        test.execute( Push { "en" } );
+        test.execute( Notifications { 2, count } );
+
+        test.execute( Close {} );
+        test.execute( Notifications { 3, count } );
+      }
+
+      {
+        ByteStreamTestHarness test { "writable high-water mark", 10, storage };
+        auto count = make_shared<uint64_t>( 0 );
+
+        test.execute( WatchWritable { 5, count } );
+        test.execute( Push { "0123456789" } );
+        test.execute( Pop { 3 } );
+        test.execute( Notifications { 0, count } );
+
+        test.execute( Pop { 2 } );
+        test.execute( Notifications { 1, count } );
+
+        test.execute( Pop { 5 } );
+        test.execute( Notifications { 1, count } );
+
+        test.execute( Push { "0123456789" } );
+        test.execute( Pop { 10 } );
+        test.execute( Notifications { 2, count } );
+
+        test.execute( SetError {} );
+        test.execute( Notifications { 3, count } );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
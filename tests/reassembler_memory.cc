@@ -0,0 +1,71 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ReassemblerTestHarness test { "in order holds nothing", 65000 };
+
+      for ( size_t i = 0; i < 100; ++i ) {
+        test.execute( Insert { string( 1000, 'x' ), 1000 * i } );
+        test.execute( PendingMemory( 0 ) );
+        test.execute( ReadAll( string( 1000, 'x' ) ) );
+      }
+      test.execute( PeakPendingMemory( 0 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "memory follows pending bytes", 65000 };
+
+      test.execute( Insert { string( 1000, 'b' ), 1000 } );
+      test.execute( BytesPending( 1000 ) );
+      test.execute( PeakPendingMemoryAtLeast( 1000 ) );
+      test.execute( PendingMemoryAtMost( 2000 ) );
+
+      test.execute( Insert { string( 1000, 'd' ), 3000 } );
+      test.execute( BytesPending( 2000 ) );
+      test.execute( PeakPendingMemoryAtLeast( 2000 ) );
+      test.execute( PendingMemoryAtMost( 4000 ) );
+
+      test.execute( Insert { string( 2000, 'a' ), 0 } );
+      test.execute( BytesPending( 1000 ) );
+      test.execute( PeakPendingMemoryAtLeast( 2000 ) );
+      test.execute( PendingMemoryAtMost( 2000 ) );
+
+      test.execute( Insert { string( 1000, 'c' ), 2000 } );
+      test.execute( BytesPending( 0 ) );
+      test.execute( PendingMemory( 0 ) );
+      test.execute( PeakPendingMemoryAtLeast( 2000 ) );
+      test.execute( BytesPushed( 4000 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "small slices don't pin large packets", 1000 };
+
+      // only the first byte of the large packet is new
+      test.execute( Insert { string( 998, 'b' ), 2 } );
+      test.execute( Insert { string( 100000, 'a' ), 1 } );
+      test.execute( BytesPending( 999 ) );
+      test.execute( PendingMemoryAtMost( 3000 ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "window-clipped packets aren't pinned", 10 };
+
+      // only a few bytes of the packet fit in the window
+      test.execute( Insert { string( 100000, 'x' ), 5 } );
+      test.execute( BytesPending( 5 ) );
+      test.execute( PendingMemoryAtMost( 1000 ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
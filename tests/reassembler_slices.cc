@@ -0,0 +1,68 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    for ( const auto storage : { ByteStream::Storage::Ring, ByteStream::Storage::Chunked } ) {
+      {
+        ReassemblerTestHarness test { "slices in order", 65000, storage };
+
+        test.execute( InsertSlice { "xxabcdyy", 2, 4, 0 } );
+        test.execute( BytesPushed( 4 ) );
+        test.execute( InsertSlice { "efgh", 0, 100, 4 } );
+        test.execute( BytesPushed( 8 ) );
+        test.execute( BytesPending( 0 ) );
+        test.execute( ReadAll( "abcdefgh" ) );
+        test.execute( IsFinished { false } );
+      }
+
+      {
+        ReassemblerTestHarness test { "slices out of order", 65000, storage };
+
+        test.execute( InsertSlice { "--efgh--", 2, 4, 4 } );
+        test.execute( BytesPushed( 0 ) );
+        test.execute( BytesPending( 4 ) );
+        test.execute( InsertSlice { "ijkl", 0, 4, 8 }.is_last() );
+        test.execute( BytesPending( 8 ) );
+        test.execute( InsertSlice { "abcdefghijkl", 0, 6, 0 } );
+        test.execute( BytesPushed( 12 ) );
+        test.execute( BytesPending( 0 ) );
+        test.execute( ReadAll( "abcdefghijkl" ) );
+        test.execute( IsFinished { true } );
+      }
+
+      {
+        ReassemblerTestHarness test { "slices beyond capacity", 8, storage };
+
+        test.execute( InsertSlice { "0123456789abcdef", 4, 12, 2 } );
+        test.execute( BytesPushed( 0 ) );
+        test.execute( BytesPending( 6 ) );
+        test.execute( Insert { "xy", 0 } );
+        test.execute( BytesPushed( 8 ) );
+        test.execute( ReadAll( "xy456789" ) );
+        test.execute( InsertSlice { "0123456789abcdef", 10, 6, 8 }.is_last() );
+        test.execute( BytesPushed( 14 ) );
+        test.execute( ReadAll( "abcdef" ) );
+        test.execute( IsFinished { true } );
+      }
+
+      {
+        ReassemblerTestHarness test { "empty slice", 65000, storage };
+
+        test.execute( InsertSlice { "abcd", 4, 3, 0 }.is_last() );
+        test.execute( BytesPushed( 0 ) );
+        test.execute( IsFinished { true } );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
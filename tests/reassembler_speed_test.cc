@@ -1,14 +1,20 @@
+#include "allocation_counter.hh"
 #include "reassembler.hh"
 
 #include <algorithm>
 #include <chrono>
 #include <cstddef>
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <queue>
 #include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
 #include <tuple>
+#include <vector>
 
 using namespace std;
 using namespace std::chrono;
@@ -83,9 +89,256 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
   }
 }
 
+struct Profile
+{
+  size_t capacity;
+  size_t segment_size;
+  size_t reorder_depth;   // segments shuffled within blocks of this many (1 = in order)
+  double duplicate_ratio; // fraction of segments that arrive a second time
+  double loss_ratio;      // fraction of segments whose first copy is lost, and that are resent a block later
+};
+
+struct Result
+{
+  double ns_per_byte;
+  double ns_per_segment;
+  double allocations_per_segment;
+  uint64_t peak_pending_memory;
+};
+
+// The order in which segments arrive, as segment numbers
+vector<size_t> make_trace( const Profile& profile, const size_t num_segments, default_random_engine& rd )
+{
+  vector<size_t> order( num_segments );
+  for ( size_t i = 0; i < num_segments; ++i ) {
+    order[i] = i;
+  }
+  for ( size_t i = 0; i < num_segments; i += profile.reorder_depth ) {
+    shuffle( order.begin() + i, order.begin() + min( i + profile.reorder_depth, num_segments ), rd );
+  }
+
+  bernoulli_distribution duplicated { profile.duplicate_ratio };
+  bernoulli_distribution lost { profile.loss_ratio };
+  vector<size_t> trace;
+  vector<size_t> resend;
+  for ( size_t i = 0; i < num_segments; ++i ) {
+    if ( i % profile.reorder_depth == 0 ) {
+      trace.insert( trace.end(), resend.begin(), resend.end() );
+      resend.clear();
+    }
+    if ( lost( rd ) ) {
+      resend.push_back( order[i] );
+      continue;
+    }
+    trace.push_back( order[i] );
+    if ( duplicated( rd ) ) {
+      trace.push_back( order[i] );
+    }
+  }
+  trace.insert( trace.end(), resend.begin(), resend.end() );
+  return trace;
+}
+
+// Stream content that depends on position, so that a reassembly that reorders or corrupts data can't go
+// unnoticed: a random pattern, repeated. Segments are slices of one shared buffer holding the pattern plus a
+// segment's worth of its start again (so every slice is contiguous), as the TCPReceiver would hand them over.
+class PatternStream
+{
+  static constexpr size_t period_ = ( 1 << 20 ) + 7;
+  Buffer source_ {};
+
+public:
+  PatternStream( const size_t max_segment_size, const size_t random_seed )
+  {
+    default_random_engine rd { random_seed };
+    uniform_int_distribution<char> ud;
+    string pattern;
+    for ( size_t i = 0; i < period_; ++i ) {
+      pattern += ud( rd );
+    }
+    pattern += pattern.substr( 0, max_segment_size );
+    source_ = Buffer { move( pattern ) };
+  }
+
+  const Buffer& source() const { return source_; }
+  static size_t offset( uint64_t index ) { return index % period_; }
+
+  // Do `data` and the stream's bytes starting at `index` match?
+  bool matches( string_view data, uint64_t index ) const
+  {
+    const string_view source = source_;
+    while ( not data.empty() ) {
+      const size_t len = min( data.size(), period_ - offset( index ) );
+      if ( data.substr( 0, len ) != source.substr( offset( index ), len ) ) {
+        return false;
+      }
+      data.remove_prefix( len );
+      index += len;
+    }
+    return true;
+  }
+};
+
+Result run_profile( const Profile& profile, const size_t total_bytes, const size_t random_seed )
+{
+  const size_t num_segments = total_bytes / profile.segment_size;
+  const size_t stream_size = num_segments * profile.segment_size;
+  default_random_engine rd { random_seed };
+  const vector<size_t> trace = make_trace( profile, num_segments, rd );
+  const PatternStream pattern { profile.segment_size, random_seed };
+
+  ByteStream stream { profile.capacity, ByteStream::Storage::Chunked };
+  Reassembler reassembler;
+  size_t inserts = 0;
+
+  // the reader checks every byte against the stream as it pops it
+  auto deliver = [&]( size_t segment ) {
+    const uint64_t first_index = segment * profile.segment_size;
+    reassembler.insert( first_index,
+                        pattern.source(),
+                        PatternStream::offset( first_index ),
+                        profile.segment_size,
+                        segment + 1 == num_segments,
+                        stream.writer() );
+    ++inserts;
+    while ( stream.reader().bytes_buffered() ) {
+      const string_view view = stream.reader().peek();
+      if ( not pattern.matches( view, stream.reader().bytes_popped() ) ) {
+        throw runtime_error( "Reassembler delivered bytes that don't match the stream at index "
+                             + to_string( stream.reader().bytes_popped() ) );
+      }
+      stream.reader().pop( view.size() );
+    }
+  };
+
+  allocation_count = 0;
+  counting_allocations = true;
+  const auto start_time = steady_clock::now();
+
+  for ( const auto segment : trace ) {
+    deliver( segment );
+  }
+  // whatever fell outside the window gets resent in order, as a sender's retransmissions would
+  while ( not stream.reader().is_finished() ) {
+    deliver( stream.reader().bytes_popped() / profile.segment_size );
+  }
+
+  const auto stop_time = steady_clock::now();
+  counting_allocations = false;
+
+  if ( stream.reader().bytes_popped() != stream_size ) {
+    throw runtime_error( "Reassembler did not deliver every segment" );
+  }
+
+  const auto test_duration = duration_cast<duration<double, nano>>( stop_time - start_time );
+  return { test_duration.count() / static_cast<double>( stream_size ),
+           test_duration.count() / static_cast<double>( num_segments ),
+           static_cast<double>( allocation_count ) / static_cast<double>( inserts ),
+           reassembler.peak_pending_memory() };
+}
+
+void in_order_speed_test( const size_t num_segments, // NOLINT(bugprone-easily-swappable-parameters)
+                          const size_t segment_size, // NOLINT(bugprone-easily-swappable-parameters)
+                          const size_t capacity )    // NOLINT(bugprone-easily-swappable-parameters)
+{
+  const auto result = run_profile( { capacity, segment_size, 1, 0, 0 }, num_segments * segment_size, 1370 );
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "Reassembler in-order insert with segment_size=" << segment_size << ", capacity=" << capacity << " took "
+       << fixed << setprecision( 1 ) << result.ns_per_segment << " ns/segment.\n";
+
+  debug_output << "     Reassembler in-order insertion: " << fixed << setprecision( 1 ) << result.ns_per_segment
+               << " ns/segment\n";
+}
+
+// Segments arrive shuffled within blocks of `reorder_depth`, so the window holds up to that many holes
+void reorder_speed_test( const size_t num_segments,  // NOLINT(bugprone-easily-swappable-parameters)
+                         const size_t segment_size,  // NOLINT(bugprone-easily-swappable-parameters)
+                         const size_t reorder_depth, // NOLINT(bugprone-easily-swappable-parameters)
+                         const size_t random_seed )  // NOLINT(bugprone-easily-swappable-parameters)
+{
+  const size_t capacity = reorder_depth * segment_size;
+  const auto result
+    = run_profile( { capacity, segment_size, reorder_depth, 0, 0 }, num_segments * segment_size, random_seed );
+  const auto gigabits_per_second = 8 / result.ns_per_byte;
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "Reassembler with segment_size=" << segment_size << ", reorder_depth=" << reorder_depth
+       << " (capacity=" << capacity << ") reached " << fixed << setprecision( 2 ) << gigabits_per_second
+       << " Gbit/s.\n";
+
+  debug_output << "   Reassembler reordered throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
+               << " Gbit/s (depth " << reorder_depth << ")\n";
+}
+
+void benchmark_matrix()
+{
+  constexpr size_t min_total_bytes = 8 << 20;
+
+  struct Arrival
+  {
+    const char* name;
+    size_t reorder_depth; // 0: the whole window
+    double duplicate_ratio;
+    double loss_ratio;
+  };
+  const vector<Arrival> arrivals { { "in_order", 1, 0, 0 },
+                                   { "reorder_16", 16, 0, 0 },
+                                   { "random", 0, 0, 0 },
+                                   { "duplicate_10pct", 16, 0.1, 0 },
+                                   { "loss_1pct", 64, 0, 0.01 } };
+
+  cout << "capacity,segment_size,arrival,reorder_depth,duplicate_ratio,loss_ratio,ns_per_byte,ns_per_segment,"
+          "allocations_per_segment,peak_pending_memory\n";
+
+  double worst_ns_per_byte = 0;
+  string worst;
+  for ( const size_t capacity : { 4UL << 10, 64UL << 10, 1UL << 20, 16UL << 20 } ) {
+    for ( const size_t segment_size : { 536UL, 1460UL, 8960UL } ) {
+      if ( segment_size > capacity ) {
+        continue;
+      }
+      for ( const auto& arrival : arrivals ) {
+        const size_t window_segments = capacity / segment_size;
+        const Profile profile { capacity,
+                                segment_size,
+                                min( window_segments, arrival.reorder_depth ? arrival.reorder_depth : SIZE_MAX ),
+                                arrival.duplicate_ratio,
+                                arrival.loss_ratio };
+        const auto result = run_profile( profile, max( min_total_bytes, 2 * capacity ), 1370 );
+
+        ostringstream row;
+        row << capacity << "," << segment_size << "," << arrival.name << "," << profile.reorder_depth << ","
+            << profile.duplicate_ratio << "," << profile.loss_ratio << "," << fixed << setprecision( 3 )
+            << result.ns_per_byte << "," << setprecision( 1 ) << result.ns_per_segment << "," << setprecision( 2 )
+            << result.allocations_per_segment << "," << result.peak_pending_memory;
+        cout << row.str() << "\n";
+
+        if ( result.ns_per_byte > worst_ns_per_byte ) {
+          worst_ns_per_byte = result.ns_per_byte;
+          worst = row.str();
+        }
+      }
+    }
+  }
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+  debug_output << "   Reassembler slowest benchmarked: " << fixed << setprecision( 3 ) << worst_ns_per_byte
+               << " ns/byte (" << worst << ")\n";
+}
+
 void program_body()
 {
   speed_test( 10000, 1500, 1370 );
+  in_order_speed_test( 1e6, 1460, 65536 );
+  reorder_speed_test( 1 << 19, 1460, 256, 1370 );
+  reorder_speed_test( 1 << 19, 1460, 8192, 1370 );
+  benchmark_matrix();
 }
 
 int main()
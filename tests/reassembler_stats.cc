@@ -0,0 +1,94 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ReassemblerTestHarness test { "duplicates", 65000 };
+
+      test.execute( Insert { "abcd", 0 } );
+      test.execute( Insert { "abcd", 0 } );
+      test.execute( DuplicateBytes( 4 ) );
+      test.execute( Insert { "cdef", 2 } );
+      test.execute( DuplicateBytes( 6 ) );
+      test.execute( OverlappingBytes( 0 ) );
+      test.execute( DroppedBytes( 0 ) );
+      test.execute( ReadAll( "abcdef" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "overlaps", 65000 };
+
+      test.execute( Insert { "cdef", 2 } );
+      test.execute( Insert { "cdef", 2 } );
+      test.execute( OverlappingBytes( 4 ) );
+      test.execute( Insert { "efgh", 4 } );
+      test.execute( OverlappingBytes( 6 ) );
+      test.execute( BytesPending( 6 ) );
+      test.execute( Insert { "abc", 0 } );
+      test.execute( OverlappingBytes( 7 ) );
+      test.execute( DuplicateBytes( 0 ) );
+      test.execute( ReadAll( "abcdefgh" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "dropped", 8 };
+
+      test.execute( Insert { "abcdefghij", 0 } );
+      test.execute( DroppedBytes( 2 ) );
+      test.execute( Insert { "ijklmnop", 8 } );
+      test.execute( DroppedBytes( 10 ) );
+      test.execute( ReadAll( "abcdefgh" ) );
+      test.execute( Insert { "ijklmnop", 8 } );
+      test.execute( DroppedBytes( 10 ) );
+      test.execute( ReadAll( "ijklmnop" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "holes", 65000 };
+
+      test.execute( Holes( 0 ) );
+      test.execute( Insert { "b", 1 } );
+      test.execute( Holes( 1 ) );
+      test.execute( Insert { "d", 3 } );
+      test.execute( Insert { "f", 5 } );
+      test.execute( Holes( 3 ) );
+      test.execute( Insert { "e", 4 } );
+      test.execute( Holes( 2 ) );
+      test.execute( Insert { "c", 2 } );
+      test.execute( Holes( 1 ) );
+      test.execute( BytesPending( 5 ) );
+      test.execute( Insert { "h", 7 } );
+      test.execute( Holes( 2 ) );
+      test.execute( Insert { "a", 0 } );
+      test.execute( Holes( 1 ) );
+      test.execute( Insert { "g", 6 } );
+      test.execute( Holes( 0 ) );
+      test.execute( MaxHoles( 3 ) );
+      test.execute( ReadAll( "abcdefgh" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "holes as the window shrinks", 4 };
+
+      test.execute( Insert { "b", 1 } );
+      test.execute( Insert { "d", 3 } );
+      test.execute( Holes( 2 ) );
+      test.execute( Push( "x" ) );
+      test.execute( Insert { "", 5 } );
+      test.execute( Holes( 1 ) );
+      test.execute( DroppedBytes( 1 ) );
+      test.execute( MaxHoles( 2 ) );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
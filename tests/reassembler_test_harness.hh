@@ -28,10 +28,19 @@ struct ReassemblerByteStreamTestStep : public TestStep<StreamAndReassembler>
 class ReassemblerTestHarness : public TestHarness<StreamAndReassembler>
 {
 public:
-  ReassemblerTestHarness( std::string test_name, uint64_t capacity )
+  ReassemblerTestHarness( std::string test_name,
+                          uint64_t capacity,
+                          ByteStream::Storage storage = ByteStream::Storage::Ring )
     : TestHarness( move( test_name ),
-                   "capacity=" + std::to_string( capacity ),
-                   { ByteStream { capacity }, Reassembler {} } )
+                   "capacity=" + std::to_string( capacity )
+                     + ( storage == ByteStream::Storage::Chunked ? ", chunked" : "" ),
+                   { ByteStream { capacity, storage }, Reassembler {} } )
+  {}
+
+  ReassemblerTestHarness( std::string test_name, uint64_t initial_capacity, uint64_t max_capacity )
+    : TestHarness( move( test_name ),
+                   "capacity=" + std::to_string( initial_capacity ) + ".." + std::to_string( max_capacity ),
+                   { ByteStream { initial_capacity, max_capacity }, Reassembler {} } )
   {}
 
   template<std::derived_from<TestStep<ByteStream>> T>
@@ -50,6 +59,83 @@ struct BytesPending : public ExpectNumber<StreamAndReassembler, uint64_t>
   uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.bytes_pending(); }
 };
 
+struct DuplicateBytes : public ExpectNumber<StreamAndReassembler, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "duplicate_bytes"; }
+  uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.duplicate_bytes(); }
+};
+
+struct OverlappingBytes : public ExpectNumber<StreamAndReassembler, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "overlapping_bytes"; }
+  uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.overlapping_bytes(); }
+};
+
+struct DroppedBytes : public ExpectNumber<StreamAndReassembler, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "dropped_bytes"; }
+  uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.dropped_bytes(); }
+};
+
+struct Holes : public ExpectNumber<StreamAndReassembler, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "holes"; }
+  uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.holes(); }
+};
+
+struct MaxHoles : public ExpectNumber<StreamAndReassembler, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "max_holes"; }
+  uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.max_holes(); }
+};
+
+struct PendingMemory : public ExpectNumber<StreamAndReassembler, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "pending_memory"; }
+  uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.pending_memory(); }
+};
+
+struct PendingMemoryAtMost : public Expectation<StreamAndReassembler>
+{
+  uint64_t bound_;
+  explicit PendingMemoryAtMost( uint64_t bound ) : bound_( bound ) {}
+  std::string description() const override { return "pending_memory <= " + std::to_string( bound_ ); }
+  void execute( StreamAndReassembler& sr ) const override
+  {
+    if ( sr.second.pending_memory() > bound_ ) {
+      throw ExpectationViolation { "pending_memory was " + std::to_string( sr.second.pending_memory() )
+                                   + ", more than " + std::to_string( bound_ ) + "." };
+    }
+  }
+};
+
+struct PeakPendingMemoryAtLeast : public Expectation<StreamAndReassembler>
+{
+  uint64_t bound_;
+  explicit PeakPendingMemoryAtLeast( uint64_t bound ) : bound_( bound ) {}
+  std::string description() const override { return "peak_pending_memory >= " + std::to_string( bound_ ); }
+  void execute( StreamAndReassembler& sr ) const override
+  {
+    if ( sr.second.peak_pending_memory() < bound_ ) {
+      throw ExpectationViolation { "peak_pending_memory was " + std::to_string( sr.second.peak_pending_memory() )
+                                   + ", less than " + std::to_string( bound_ ) + "." };
+    }
+  }
+};
+
+struct PeakPendingMemory : public ExpectNumber<StreamAndReassembler, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "peak_pending_memory"; }
+  uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.peak_pending_memory(); }
+};
+
 struct Insert : public Action<StreamAndReassembler>
 {
   std::string data_;
@@ -79,3 +165,38 @@ struct Insert : public Action<StreamAndReassembler>
     sr.second.insert( first_index_, data_, is_last_substring_, sr.first.writer() );
   }
 };
+
+struct InsertSlice : public Action<StreamAndReassembler>
+{
+  Buffer data_;
+  uint64_t offset_;
+  uint64_t len_;
+  uint64_t first_index_;
+  bool is_last_substring_ {};
+
+  InsertSlice( std::string data, uint64_t offset, uint64_t len, uint64_t first_index )
+    : data_( move( data ) ), offset_( offset ), len_( len ), first_index_( first_index )
+  {}
+
+  InsertSlice& is_last( bool status = true )
+  {
+    is_last_substring_ = status;
+    return *this;
+  }
+
+  std::string description() const override
+  {
+    std::ostringstream ss;
+    ss << "insert slice [" << offset_ << ", +" << len_ << ") of \"" << Printer::prettify( data_ ) << "\" @ index "
+       << first_index_;
+    if ( is_last_substring_ ) {
+      ss << " [last substring]";
+    }
+    return ss.str();
+  }
+
+  void execute( StreamAndReassembler& sr ) const override
+  {
+    sr.second.insert( first_index_, data_, offset_, len_, is_last_substring_, sr.first.writer() );
+  }
+};
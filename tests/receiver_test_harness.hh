@@ -5,9 +5,11 @@
 #include "tcp_receiver.hh"
 #include "tcp_receiver_message.hh"
 
+#include <algorithm>
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 using ReceiverSet = std::pair<StreamAndReassembler, TCPReceiver>;
 
@@ -94,6 +96,35 @@ struct ExpectAcknoBetween : public Expectation<ReceiverSet>
   }
 };
 
+inline std::string to_string( const std::vector<SACKBlock>& blocks )
+{
+  std::string ret;
+  for ( const auto& [left, right] : blocks ) {
+    ret += "[" + to_string( left ) + ", " + to_string( right ) + ") ";
+  }
+  return ret.empty() ? "none" : ret.substr( 0, ret.size() - 1 );
+}
+
+// The SACK blocks the receiver would send, given what the Reassembler holds
+struct ExpectSACKBlocks : public Expectation<ReceiverSet>
+{
+  std::vector<SACKBlock> blocks_;
+  explicit ExpectSACKBlocks( std::vector<SACKBlock> blocks ) : blocks_( std::move( blocks ) ) {}
+  std::string description() const override { return "sack_blocks = " + to_string( blocks_ ); }
+  void execute( ReceiverSet& rs ) const override
+  {
+    const auto blocks = rs.second.send( rs.first.first.writer(), rs.first.second ).sack_blocks;
+    const auto same = []( const SACKBlock& a, const SACKBlock& b ) {
+      return a.left == b.left and a.right == b.right;
+    };
+    const bool equal = std::equal( blocks.begin(), blocks.end(), blocks_.begin(), blocks_.end(), same );
+    if ( not equal ) {
+      throw ExpectationViolation { "The TCPReceiver should have sent SACK blocks " + to_string( blocks_ )
+                                   + ", but instead it sent " + to_string( blocks ) + "." };
+    }
+  }
+};
+
 struct HasAckno : public ExpectBool<ReceiverSet>
 {
   using ExpectBool::ExpectBool;
@@ -0,0 +1,164 @@
+#include "random.hh"
+#include "receiver_test_harness.hh"
+#include "tcp_over_ip.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "SACK blocks report the runs held beyond the ackno", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectSACKBlocks { {} } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efgh" ) );
+      test.execute( ExpectSACKBlocks { { { Wrap32 { isn + 5 }, Wrap32 { isn + 9 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 13 ).with_data( "mnop" ) );
+      test.execute( ExpectSACKBlocks {
+        { { Wrap32 { isn + 5 }, Wrap32 { isn + 9 } }, { Wrap32 { isn + 13 }, Wrap32 { isn + 17 } } } } );
+
+      // adjacent runs join up
+      test.execute( SegmentArrives {}.with_seqno( isn + 9 ).with_data( "ijkl" ) );
+      test.execute( ExpectSACKBlocks { { { Wrap32 { isn + 5 }, Wrap32 { isn + 17 } } } } );
+
+      // filling the first hole acknowledges everything
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 17 } } );
+      test.execute( ExpectSACKBlocks { {} } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "At most four SACK blocks, lowest first", 2358 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      for ( uint32_t i = 1; i <= 6; i++ ) {
+        test.execute( SegmentArrives {}.with_seqno( isn + 1 + 10 * i ).with_data( "xy" ) );
+      }
+      test.execute( ExpectSACKBlocks { { { Wrap32 { isn + 11 }, Wrap32 { isn + 13 } },
+                                         { Wrap32 { isn + 21 }, Wrap32 { isn + 23 } },
+                                         { Wrap32 { isn + 31 }, Wrap32 { isn + 33 } },
+                                         { Wrap32 { isn + 41 }, Wrap32 { isn + 43 } } } } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPSegment seg;
+      seg.sender_message.seqno = Wrap32 { isn };
+      seg.sender_message.SYN = true;
+      seg.sender_message.payload = string( "hello" );
+      seg.sack_permitted = true;
+      seg.receiver_message.ackno = Wrap32 { isn + 1 };
+      seg.receiver_message.window_size = 1000;
+      seg.receiver_message.sack_blocks = { { Wrap32 { isn + 5 }, Wrap32 { isn + 9 } },
+                                           { Wrap32 { isn + 13 }, Wrap32 { isn + 17 } } };
+      seg.compute_checksum( 0 );
+
+      TCPSegment parsed;
+      if ( not parse( parsed, serialize( seg ), 0 ) ) {
+        throw runtime_error( "TCPSegment with SACK options failed to parse" );
+      }
+      const auto& blocks = parsed.receiver_message.sack_blocks;
+      if ( not parsed.sack_permitted or blocks.size() != 2 or blocks[0].left != Wrap32 { isn + 5 }
+           or blocks[0].right != Wrap32 { isn + 9 } or blocks[1].left != Wrap32 { isn + 13 }
+           or blocks[1].right != Wrap32 { isn + 17 } ) {
+        throw runtime_error( "TCPSegment SACK options did not round-trip" );
+      }
+      if ( string_view( parsed.sender_message.payload ) != "hello"
+           or parsed.receiver_message.ackno != Wrap32 { isn + 1 } ) {
+        throw runtime_error( "TCPSegment with SACK options lost its ackno or payload" );
+      }
+    }
+
+    {
+      // the IPv4 length and the pseudo-header checksum cover the TCP options too
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPSegment syn;
+      syn.sender_message.seqno = Wrap32 { isn };
+      syn.sender_message.SYN = true;
+      syn.sack_permitted = true;
+      TCPSegment ack;
+      ack.sender_message.seqno = Wrap32 { isn + 1 };
+      ack.sender_message.payload = string( "hello" );
+      ack.receiver_message.ackno = Wrap32 { isn };
+      ack.receiver_message.window_size = 1000;
+      ack.receiver_message.sack_blocks = { { Wrap32 { isn + 5 }, Wrap32 { isn + 9 } },
+                                           { Wrap32 { isn + 13 }, Wrap32 { isn + 17 } } };
+      // a SYN+ACK with four pending ranges: with MSS and SACK-permitted, only three blocks fit in 40 bytes
+      TCPSegment syn_ack;
+      syn_ack.sender_message.seqno = Wrap32 { isn };
+      syn_ack.sender_message.SYN = true;
+      syn_ack.sack_permitted = true;
+      syn_ack.mss = 1460;
+      syn_ack.receiver_message.ackno = Wrap32 { isn };
+      syn_ack.receiver_message.window_size = 1000;
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        const uint32_t left = isn + 5 + 10 * i;
+        syn_ack.receiver_message.sack_blocks.push_back( { Wrap32 { left }, Wrap32 { left + 4 } } );
+      }
+
+      TCPOverIPv4Adapter adapter;
+      adapter.config_mut().source = Address { "10.0.0.1", 1234 };
+      adapter.config_mut().destination = Address { "10.0.0.2", 5678 };
+      const auto syn_datagrams = adapter.wrap_tcp_in_ip( syn );
+      const auto ack_datagrams = adapter.wrap_tcp_in_ip( ack );
+      const auto syn_ack_datagrams = adapter.wrap_tcp_in_ip( syn_ack );
+
+      adapter.config_mut().source = Address { "10.0.0.2", 5678 };
+      adapter.config_mut().destination = Address { "10.0.0.1", 1234 };
+      const auto round_trip = [&]( const TCPSegment& seg, const vector<InternetDatagram>& dgrams, size_t blocks ) {
+        if ( dgrams.size() != 1 or seg.header_length() <= 20 ) {
+          throw runtime_error( "TCPSegment with SACK options was not wrapped in one datagram with options" );
+        }
+        const auto& dgram = dgrams.front();
+        uint64_t tcp_length = 0;
+        for ( const auto& buffer : dgram.payload ) {
+          tcp_length += buffer.size();
+        }
+        if ( dgram.header.len != dgram.header.hlen * 4 + tcp_length
+             or tcp_length != seg.header_length() + seg.sender_message.payload.size() ) {
+          throw runtime_error( "IPv4 length of a TCPSegment with SACK options left out its options" );
+        }
+
+        InternetDatagram reparsed;
+        if ( not parse( reparsed, serialize( dgram ) ) ) {
+          throw runtime_error( "IPv4 datagram carrying SACK options failed to parse" );
+        }
+        const auto unwrapped = adapter.unwrap_tcp_in_ip( reparsed );
+        if ( not unwrapped.has_value() ) {
+          throw runtime_error( "TCPSegment with SACK options failed to unwrap (bad length or checksum)" );
+        }
+        if ( unwrapped->sack_permitted != seg.sack_permitted
+             or unwrapped->receiver_message.sack_blocks.size() != blocks
+             or string_view( unwrapped->sender_message.payload ) != string_view( seg.sender_message.payload ) ) {
+          throw runtime_error( "TCPSegment with SACK options did not survive wrap and unwrap" );
+        }
+        return unwrapped.value();
+      };
+      round_trip( syn, syn_datagrams, 0 );
+      round_trip( ack, ack_datagrams, 2 );
+      const auto parsed = round_trip( syn_ack, syn_ack_datagrams, 3 );
+      if ( syn_ack.header_length() != 56 or parsed.mss != 1460 or not parsed.sender_message.SYN
+           or parsed.receiver_message.ackno != Wrap32 { isn }
+           or parsed.receiver_message.sack_blocks.back().left != Wrap32 { isn + 25 } ) {
+        throw runtime_error( "SYN+ACK with more SACK blocks than fit did not keep its other options" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,195 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "No congestion control by default", cfg };
+      test.execute( ExpectCongestionWindow { UINT64_MAX } );
+      test.execute( ExpectSlowStartThreshold { UINT64_MAX } );
+      test.execute( ExpectPacingRateInRange { 0, 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "NewReno slow start limits the data in flight", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 4000 } );
+      test.execute( Push( string( 10000, 'x' ) ) );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 4000 } );
+
+      // each ack grows the window by (at most) one MSS
+      test.execute( AckReceived { isn + 1001 }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 5000 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 4001 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 5001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 6001 }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 6000 } );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 6001 + 1000 * i ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_control = CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "NewReno paces by the sender's own smoothed RTT", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push( string( 1000, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { isn + 1001 }.with_win( 60000 ) );
+      // 7/8 * 100 + 1/8 * 50 = 93.75 ms, and slow start paces 2 * 5000 bytes per round trip
+      test.execute( ExpectSmoothedRTT { 94 } );
+      test.execute( ExpectCongestionWindow { 5000 } );
+      test.execute( ExpectPacingRateInRange { 106382, 106382 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      const uint64_t rto = uniform_int_distribution<uint16_t> { 30, 10000 }( rd );
+      cfg.fixed_isn = isn;
+      cfg.rt_timeout = rto;
+      cfg.congestion_control = CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "NewReno collapses the window on timeout, then avoids congestion", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push( string( 4000, 'x' ) ) );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      }
+      test.execute( Tick { rto } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( ExpectSlowStartThreshold { 2000 } );
+
+      test.execute( AckReceived { isn + 4001 }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      test.execute( Push( string( 4000, 'y' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // at ssthresh: one more MSS per window of acknowledged data
+      test.execute( AckReceived { isn + 5001 }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      test.execute( AckReceived { isn + 6001 }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 3000 } );
+      test.execute( ExpectSlowStartThreshold { 2000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      const uint64_t rto = 1000;
+      cfg.fixed_isn = isn;
+      cfg.rt_timeout = rto;
+      cfg.congestion_control = CongestionControl::Cubic;
+
+      TCPSenderTestHarness test { "CUBIC backs off by 30% and grows back past where it lost", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push( string( 4000, 'x' ) ) );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+      test.execute( Tick { rto } );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( ExpectSlowStartThreshold { 2800 } );
+      // the retransmission fills the hole, and the receiver acknowledges the whole window
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      // with more in flight than the collapsed window allows, new data waits for the ack
+      test.execute( Push( string( 1000, 'z' ) ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 4000 } );
+      test.execute( AckReceived { isn + 4001 }.with_win( 60000 ) );
+
+      for ( int i = 0; i < 2; ++i ) {
+        test.execute( Push( string( 10000, 'y' ) ) );
+        test.execute( RoundTrip { 100, 60000 } );
+      }
+      test.execute( ExpectCongestionWindowInRange { 2800, 4000 } );
+      for ( int i = 0; i < 30; ++i ) {
+        test.execute( Push( string( 10000, 'y' ) ) );
+        test.execute( RoundTrip { 100, 60000 } );
+      }
+      test.execute( ExpectCongestionWindowInRange { 4001, 60000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.rt_timeout = 1000;
+      cfg.congestion_control = CongestionControl::BBR;
+
+      TCPSenderTestHarness test { "BBR paces at the measured bandwidth and sizes the window to the BDP", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( ExpectPacingRateInRange { 0, 0 } );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 10000 } );
+
+      // the receiver's window caps delivery at 40000 bytes per 50 ms round trip: 800 kB/s
+      for ( int i = 0; i < 20; ++i ) {
+        test.execute( Push( string( 40000, 'x' ) ) );
+        test.execute( RoundTrip { 50, 40000 } );
+      }
+      test.execute( ExpectPacingRateInRange { 600000, 1000000 } );
+      test.execute( ExpectCongestionWindowInRange { 60000, 90000 } );
+
+      // a timeout shrinks the window, which grows back towards the BDP target as acks arrive
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( Tick { 1000 } );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( Push( string( 40000, 'x' ) ) );
+      test.execute( RoundTrip { 50, 40000 } );
+      test.execute( ExpectCongestionWindowInRange { 4000, 90000 } );
+      test.execute( ExpectPacingRateInRange { 600000, 1000000 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+#include "tcp_over_ip.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = 1460;
+
+      TCPSenderTestHarness test { "Segments carry up to the configured MSS", cfg };
+      test.execute( ExpectMSS { 1460 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 4000 ) );
+      test.execute( Push( string( 4000, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1460 ).with_seqno( isn + 1461 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1080 ).with_seqno( isn + 2921 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = 1460;
+      cfg.congestion_control = CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "A smaller negotiated MSS shrinks segments and the initial window", cfg };
+      test.execute( ExpectCongestionWindow { 4380 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( SetMSS { 536 } );
+      test.execute( ExpectMSS { 536 } );
+      test.execute( ExpectCongestionWindow { 2144 } );
+      test.execute( SetMSS { 0 } );
+      test.execute( ExpectMSS { 536 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 4000 ) );
+      test.execute( Push( string( 4000, 'x' ) ) );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 536 ).with_seqno( isn + 1 + 536 * i ) );
+      }
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.mss = 1460;
+      cfg.super_segments = true;
+
+      TCPSenderTestHarness test { "Super-segments carry as many whole MSS as fit", cfg };
+      test.execute( ExpectMSS { 1460 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 64000 ) );
+      test.execute( Push( string( 64000, 'x' ) ) );
+      // 43 * 1460 = 62780 bytes, then the rest of the window
+      test.execute( ExpectMessage {}.with_payload_size( 62780 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1220 ).with_seqno( isn + 62781 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 64001 }.with_win( 64000 ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPSegment seg;
+      seg.sender_message.seqno = Wrap32 { isn };
+      seg.sender_message.SYN = true;
+      seg.sack_permitted = true;
+      seg.mss = 8960;
+      seg.compute_checksum( 0 );
+
+      TCPSegment parsed;
+      if ( not parse( parsed, serialize( seg ), 0 ) ) {
+        throw runtime_error( "TCPSegment with an MSS option failed to parse" );
+      }
+      if ( parsed.mss != 8960 or not parsed.sack_permitted or parsed.header_length() != 28 ) {
+        throw runtime_error( "TCPSegment MSS option did not round-trip" );
+      }
+
+      seg.sender_message.SYN = false;
+      if ( seg.header_length() != 20 ) {
+        throw runtime_error( "TCPSegment without SYN carried options" );
+      }
+    }
+
+    {
+      // a super-segment with SYN and FIN, cut into 1000-byte pieces
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      string data( 2500, 'x' );
+      for ( size_t i = 0; i < data.size(); ++i ) {
+        data[i] = static_cast<char>( 'a' + i % 26 );
+      }
+      TCPSegment seg;
+      seg.sender_message = { Wrap32 { isn }, true, data, true };
+      seg.mss = 1000;
+      seg.split_size = 1000;
+
+      TCPOverIPv4Adapter adapter;
+      adapter.config_mut().source = Address { "10.0.0.1", 1234 };
+      adapter.config_mut().destination = Address { "10.0.0.2", 5678 };
+      const auto datagrams = adapter.wrap_tcp_in_ip( seg );
+      if ( datagrams.size() != 3 ) {
+        throw runtime_error( "super-segment was split into " + to_string( datagrams.size() ) + " datagrams" );
+      }
+
+      adapter.config_mut().source = Address { "10.0.0.2", 5678 };
+      adapter.config_mut().destination = Address { "10.0.0.1", 1234 };
+      string reassembled;
+      for ( size_t i = 0; i < datagrams.size(); ++i ) {
+        const auto piece = adapter.unwrap_tcp_in_ip( datagrams[i] );
+        if ( not piece.has_value() ) {
+          throw runtime_error( "piece " + to_string( i ) + " of a super-segment failed to parse" );
+        }
+        const auto& msg = piece->sender_message;
+        if ( msg.SYN != ( i == 0 ) or msg.FIN != ( i == 2 ) or ( msg.SYN and piece->mss != 1000 ) ) {
+          throw runtime_error( "piece " + to_string( i ) + " of a super-segment has the wrong flags" );
+        }
+        if ( msg.seqno != Wrap32 { isn } + static_cast<uint32_t>( i == 0 ? 0 : 1 + reassembled.size() ) ) {
+          throw runtime_error( "piece " + to_string( i ) + " of a super-segment has the wrong seqno" );
+        }
+        if ( datagrams[i].header.len != 40 + ( i == 0 ? 4 : 0 ) + msg.payload.size() ) {
+          throw runtime_error( "piece " + to_string( i ) + " of a super-segment has the wrong length" );
+        }
+        reassembled += string_view( msg.payload );
+      }
+      if ( reassembled != data ) {
+        throw runtime_error( "super-segment pieces did not carry its payload" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Segments go out in a burst by default", cfg };
+      test.execute( ExpectNextSendTime { nullopt } );
+      test.execute( Push {} );
+      test.execute( ExpectNextSendTime { 0 } );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( ExpectNextSendTime { nullopt } );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 4000 ) );
+      test.execute( Push( string( 4000, 'x' ) ) );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectNextSendTime { 0 } );
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+      test.execute( ExpectNextSendTime { nullopt } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.pacing = true;
+
+      TCPSenderTestHarness test { "Without a congestion controller, a window is spread over a round trip", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 4000 ) );
+      // 4000 bytes per 100 ms: one segment every 25 ms
+      test.execute( ExpectPacingRateInRange { 40000, 40000 } );
+      test.execute( Push( string( 4000, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      for ( uint32_t i = 1; i < 4; ++i ) {
+        test.execute( ExpectNextSendTime { 25 } );
+        test.execute( ExpectNoSegment {} );
+        test.execute( Tick { 24 } );
+        test.execute( ExpectNextSendTime { 1 } );
+        test.execute( ExpectNoSegment {} );
+        test.execute( Tick { 1 } );
+        test.execute( ExpectNextSendTime { 0 } );
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+      test.execute( ExpectNextSendTime { nullopt } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.pacing = true;
+
+      TCPSenderTestHarness test { "Time spent waiting for the pacer is not part of the round trip", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 4000 ) );
+      test.execute( ExpectSmoothedRTT { 100 } );
+      test.execute( Push( string( 4000, 'x' ) ) );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        if ( i > 0 ) {
+          test.execute( Tick { 25 } );
+        }
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+      // the last segment was cut 175 ms before the ack, but spent 75 of them in the pacer
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { isn + 4001 }.with_win( 4000 ) );
+      test.execute( ExpectSmoothedRTT { 100 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.rt_timeout = 50;
+      cfg.pacing = true;
+
+      TCPSenderTestHarness test { "A retransmission goes ahead of new segments waiting for the pacer", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Tick { 40 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 4000 ) );
+      // 4000 bytes per 40 ms: one segment every 10 ms
+      test.execute( Push( string( 4000, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNoSegment {} );
+      // the first segment is lost, and times out while the other three are still queued
+      test.execute( Tick { 50 } );
+      test.execute( ExpectTimeoutRetransmissions { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( Tick { 10 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.pacing = true;
+
+      TCPSenderTestHarness test { "Idle time earns no burst", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 4000 ) );
+      test.execute( Push( string( 1000, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { isn + 1001 }.with_win( 4000 ) );
+      test.execute( Push( string( 2000, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectNextSendTime { 25 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.pacing = true;
+      cfg.congestion_control = CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "Pacing follows the congestion controller's rate", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      // slow start paces at twice the window per round trip: 80000 bytes/s, a segment every 12.5 ms
+      test.execute( ExpectPacingRateInRange { 80000, 80000 } );
+      test.execute( Push( string( 4000, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectNextSendTime { 13 } );
+      test.execute( Tick { 12 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 13 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 2001 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Duplicate acks are ignored by default", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 6000 ) );
+      test.execute( Push( string( 3000, 'x' ) ) );
+      for ( uint32_t i = 0; i < 3; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { isn + 1 }.with_win( 6000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRetransmissions { 0 } );
+      test.execute( Tick { TCPConfig::TIMEOUT_DFLT } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectTimeoutRetransmissions { 1 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "Third duplicate ack retransmits; partial acks retransmit again", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 6000 ) );
+      test.execute( Push( string( 5000, 'x' ) ) );
+      for ( uint32_t i = 0; i < 5; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+
+      // the second and fourth segments were lost
+      test.execute( AckReceived { isn + 1001 }.with_win( 6000 ) );
+      test.execute( AckReceived { isn + 1001 }.with_win( 6000 ) );
+      test.execute( AckReceived { isn + 1001 }.with_win( 6000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 1001 }.with_win( 6000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( ExpectFastRetransmissions { 1 } );
+      test.execute( AckReceived { isn + 1001 }.with_win( 6000 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // the retransmission fills the first hole, and the ack stops at the next one
+      test.execute( AckReceived { isn + 3001 }.with_win( 6000 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 3001 ) );
+      test.execute( ExpectFastRetransmissions { 2 } );
+      test.execute( AckReceived { isn + 5001 }.with_win( 6000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectTimeoutRetransmissions { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+
+      TCPSenderTestHarness test { "Repeated acks that change the window are not duplicates", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 6000 ) );
+      test.execute( Push( string( 2000, 'x' ) ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1001 ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 5000 ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 4000 ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 3000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRetransmissions { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.fast_retransmit = true;
+      cfg.congestion_control = CongestionControl::NewReno;
+
+      TCPSenderTestHarness test { "Fast retransmit halves the congestion window", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( ExpectCongestionWindow { 4000 } );
+      test.execute( Push( string( 4000, 'x' ) ) );
+      for ( uint32_t i = 0; i < 4; ++i ) {
+        test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 + 1000 * i ) );
+      }
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      }
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectSlowStartThreshold { 2000 } );
+      test.execute( ExpectCongestionWindow { 2000 } );
+
+      // the timer restarted with the retransmission
+      test.execute( Tick { TCPConfig::TIMEOUT_DFLT - 1 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectTimeoutRetransmissions { 1 } );
+      test.execute( ExpectCongestionWindow { 1000 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "RTT is measured, but the RTO stays fixed by default", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( ExpectSmoothedRTT { 0 } );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { isn + 1 } );
+      test.execute( ExpectSmoothedRTT { 50 } );
+      test.execute( ExpectRTO { TCPConfig::TIMEOUT_DFLT } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rto = RTOBounds { 10, 60000 };
+
+      TCPSenderTestHarness test { "RTO follows SRTT + 4 * RTTVAR", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( ExpectRTO { TCPConfig::TIMEOUT_DFLT } );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { isn + 1 } );
+      // first sample: SRTT = 50, RTTVAR = 25
+      test.execute( ExpectSmoothedRTT { 50 } );
+      test.execute( ExpectRTO { 150 } );
+
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_seqno( isn + 1 ) );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { isn + 4 } );
+      // RTTVAR = 3/4 * 25 + 1/4 * 0
+      test.execute( ExpectSmoothedRTT { 50 } );
+      test.execute( ExpectRTO { 125 } );
+
+      // a lost segment is retransmitted after a few RTTs, not after the default second
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_data( "def" ).with_seqno( isn + 4 ) );
+      test.execute( Tick { 124 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "def" ).with_seqno( isn + 4 ) );
+      test.execute( ExpectRTO { 250 } );
+      test.execute( Tick { 249 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "def" ).with_seqno( isn + 4 ) );
+      test.execute( ExpectRTO { 500 } );
+
+      // Karn's algorithm: the ack of a retransmitted segment is not a sample, and the backoff ends
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { isn + 7 } );
+      test.execute( ExpectSmoothedRTT { 50 } );
+      test.execute( ExpectRTO { 125 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rto = RTOBounds {};
+
+      TCPSenderTestHarness test { "RTO is at least the lower bound", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Tick { 5 } );
+      test.execute( AckReceived { isn + 1 } );
+      test.execute( ExpectSmoothedRTT { 5 } );
+      test.execute( ExpectRTO { 200 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rto = RTOBounds { 10, 300 };
+
+      TCPSenderTestHarness test { "Backoff stops at the upper bound", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { isn + 1 } );
+      test.execute( ExpectRTO { 150 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_seqno( isn + 1 ) );
+      test.execute( Tick { 150 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_seqno( isn + 1 ) );
+      test.execute( ExpectRTO { 300 } );
+      test.execute( Tick { 300 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_seqno( isn + 1 ) );
+      test.execute( ExpectRTO { 300 } );
+      test.execute( Tick { 300 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ).with_seqno( isn + 1 ) );
+      test.execute( ExpectRTO { 300 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
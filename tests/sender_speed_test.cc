@@ -0,0 +1,122 @@
+#include "allocation_counter.hh"
+#include "byte_stream.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+struct Result
+{
+  double ns_per_segment;
+  double gigabits_per_second;
+  double allocations_per_segment;
+};
+
+// Send `total_bytes` through a TCPSender, `batch` segments per push(), to a receiver that acknowledges every
+// window as soon as it has been sent. Only the sender's own calls are timed.
+Result run( const uint64_t total_bytes, const uint64_t window, const uint64_t batch )
+{
+  // the application's data: slices of one string, handed to a chunked stream without copying
+  constexpr uint64_t chunk_size = 64000;
+  const Buffer data { string( chunk_size, 'x' ) };
+
+  ByteStream stream { 4 * chunk_size, ByteStream::Storage::Chunked };
+  TCPConfig config;
+  config.fixed_isn = Wrap32 { 0 };
+  TCPSender sender { config };
+
+  const auto window_size = static_cast<uint16_t>( window );
+  sender.push( stream.reader() );
+  const auto syn = sender.maybe_send();
+  sender.receive( { syn->seqno + 1, window_size } );
+
+  uint64_t pushed = 0;
+  uint64_t segments = 0;
+  duration<double, nano> elapsed {};
+  while ( stream.reader().bytes_popped() < total_bytes ) {
+    while ( pushed < total_bytes && stream.writer().available_capacity() >= chunk_size ) {
+      stream.writer().push( data );
+      pushed += chunk_size;
+    }
+
+    const auto start = steady_clock::now();
+    counting_allocations = true;
+    optional<TCPSenderMessage> last;
+    while ( sender.push( stream.reader(), batch ) > 0 ) {
+      while ( auto msg = sender.maybe_send() ) {
+        last = move( msg );
+        ++segments;
+      }
+    }
+    if ( last.has_value() ) {
+      sender.receive( { last->seqno + static_cast<uint32_t>( last->sequence_length() ), window_size } );
+    }
+    counting_allocations = false;
+    elapsed += steady_clock::now() - start;
+  }
+
+  if ( sender.sequence_numbers_in_flight() != 0 ) {
+    throw runtime_error( "TCPSender left data unacknowledged" );
+  }
+
+  const auto seconds = elapsed.count() / 1e9;
+  return { elapsed.count() / static_cast<double>( segments ),
+           static_cast<double>( total_bytes ) * 8 / seconds / 1e9,
+           static_cast<double>( allocation_count ) / static_cast<double>( segments ) };
+}
+
+void program_body()
+{
+  constexpr uint64_t total_bytes = 1UL << 30;
+
+  cout << "window,batch,ns_per_segment,gbps,allocations_per_segment\n";
+
+  double best_gbps = 0;
+  string best;
+  for ( const uint64_t window : { 8000UL, 64000UL } ) {
+    for ( const uint64_t batch : { 1UL, 8UL, 64UL, UINT64_MAX } ) {
+      allocation_count = 0;
+      const auto result = run( total_bytes, window, batch );
+
+      ostringstream row;
+      row << window << "," << ( batch == UINT64_MAX ? "all" : to_string( batch ) ) << "," << fixed
+          << setprecision( 1 ) << result.ns_per_segment << "," << setprecision( 2 ) << result.gigabits_per_second
+          << "," << setprecision( 3 ) << result.allocations_per_segment;
+      cout << row.str() << "\n";
+
+      if ( result.gigabits_per_second > best_gbps ) {
+        best_gbps = result.gigabits_per_second;
+        best = row.str();
+      }
+    }
+  }
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+  debug_output << "           TCPSender throughput: " << fixed << setprecision( 2 ) << best_gbps << " Gbit/s ("
+               << best << ")\n";
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
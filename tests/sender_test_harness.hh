@@ -54,6 +54,100 @@ struct ExpectSeqnosInFlight : public ExpectNumber<StreamAndSender, uint64_t>
   uint64_t value( StreamAndSender& ss ) const override { return ss.second.sequence_numbers_in_flight(); }
 };
 
+struct ExpectCongestionWindow : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion_window"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.congestion_window(); }
+};
+
+struct ExpectSlowStartThreshold : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "slow_start_threshold"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.slow_start_threshold(); }
+};
+
+struct ExpectSmoothedRTT : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "smoothed_RTT_ms"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.smoothed_RTT_ms(); }
+};
+
+struct ExpectRTO : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "current_RTO_ms"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.current_RTO_ms(); }
+};
+
+struct ExpectFastRetransmissions : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "fast_retransmissions"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.fast_retransmissions(); }
+};
+
+struct ExpectTimeoutRetransmissions : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "timeout_retransmissions"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.timeout_retransmissions(); }
+};
+
+struct ExpectNextSendTime : public ExpectNumber<StreamAndSender, std::optional<uint64_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "next_send_time"; }
+  std::optional<uint64_t> value( StreamAndSender& ss ) const override { return ss.second.next_send_time(); }
+};
+
+struct ExpectMSS : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "MSS"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.MSS(); }
+};
+
+// Expect a number to lie within [min, max]
+template<typename Num>
+struct ExpectRange : public Expectation<StreamAndSender>
+{
+  Num min_;
+  Num max_;
+  ExpectRange( Num min, Num max ) : min_( min ), max_( max ) {}
+  virtual std::string name() const = 0;
+  virtual Num value( StreamAndSender& ss ) const = 0;
+  std::string description() const override
+  {
+    return name() + " in [" + std::to_string( min_ ) + ", " + std::to_string( max_ ) + "]";
+  }
+  void execute( StreamAndSender& ss ) const override
+  {
+    const Num result = value( ss );
+    if ( result < min_ or result > max_ ) {
+      throw ExpectationViolation { "The object should have had " + name() + " in [" + std::to_string( min_ ) + ", "
+                                   + std::to_string( max_ ) + "], but instead it was " + std::to_string( result )
+                                   + "." };
+    }
+  }
+};
+
+struct ExpectCongestionWindowInRange : public ExpectRange<uint64_t>
+{
+  using ExpectRange::ExpectRange;
+  std::string name() const override { return "congestion_window"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.congestion_window(); }
+};
+
+struct ExpectPacingRateInRange : public ExpectRange<uint64_t>
+{
+  using ExpectRange::ExpectRange;
+  std::string name() const override { return "pacing_rate"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.pacing_rate(); }
+};
+
 struct ExpectNoSegment : public Expectation<StreamAndSender>
 {
   std::string description() const override { return "nothing to send"; }
@@ -145,6 +239,16 @@ struct Tick : public Action<StreamAndSender>
   }
 };
 
+struct SetMSS : public Action<StreamAndSender>
+{
+  uint64_t MSS_;
+
+  explicit SetMSS( uint64_t MSS ) : MSS_( MSS ) {}
+
+  std::string description() const override { return "MSS set to " + std::to_string( MSS_ ); }
+  void execute( StreamAndSender& ss ) const override { ss.second.set_MSS( MSS_ ); }
+};
+
 struct Receive : public Action<StreamAndSender>
 {
   TCPReceiverMessage msg_;
@@ -154,7 +258,11 @@ struct Receive : public Action<StreamAndSender>
   std::string description() const override
   {
     std::ostringstream desc;
-    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size << ")";
+    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size;
+    for ( const auto& [left, right] : msg_.sack_blocks ) {
+      desc << ", sack=[" << left << ", " << right << ")";
+    }
+    desc << ")";
     if ( push_ ) {
       desc << ", then push stream to TCPSender";
     }
@@ -175,6 +283,12 @@ struct Receive : public Action<StreamAndSender>
     }
   }
 
+  Receive& with_sack( Wrap32 left, Wrap32 right )
+  {
+    msg_.sack_blocks.push_back( { left, right } );
+    return *this;
+  }
+
   Receive& without_push()
   {
     push_ = false;
@@ -187,6 +301,35 @@ struct AckReceived : public Receive
   explicit AckReceived( Wrap32 ackno ) : Receive( { ackno, DEFAULT_TEST_WINDOW } ) {}
 };
 
+// Send everything the sender will send, let `rtt_ms` pass, then acknowledge all of it
+struct RoundTrip : public Action<StreamAndSender>
+{
+  uint64_t rtt_ms_;
+  uint16_t window_;
+
+  explicit RoundTrip( uint64_t rtt_ms, uint16_t window = UINT16_MAX ) : rtt_ms_( rtt_ms ), window_( window ) {}
+
+  std::string description() const override
+  {
+    return "send all segments, " + std::to_string( rtt_ms_ ) + " ms pass, then receive an ack for all of them (win="
+           + std::to_string( window_ ) + ")";
+  }
+
+  void execute( StreamAndSender& ss ) const override
+  {
+    ss.second.push( ss.first.reader() );
+    std::optional<TCPSenderMessage> last;
+    while ( auto msg = ss.second.maybe_send() ) {
+      last = std::move( msg );
+    }
+    ss.second.tick( rtt_ms_ );
+    if ( last.has_value() ) {
+      ss.second.receive( { last->seqno + static_cast<uint32_t>( last->sequence_length() ), window_ } );
+    }
+    ss.second.push( ss.first.reader() );
+  }
+};
+
 struct Close : public Push
 {
   Close() : Push( "" ) { with_close(); }
@@ -290,7 +433,7 @@ struct ExpectMessage : public Expectation<StreamAndSender>
     if ( payload_size.has_value() and seg.payload.size() != payload_size.value() ) {
       throw ExpectationViolation( "payload_size", payload_size.value(), seg.payload.size() );
     }
-    if ( seg.payload.size() > TCPConfig::MAX_PAYLOAD_SIZE ) {
+    if ( seg.payload.size() > ss.second.max_payload_size() ) {
       throw ExpectationViolation( "payload has length (" + std::to_string( seg.payload.size() )
                                   + ") greater than the maximum" );
     }
@@ -307,6 +450,6 @@ public:
   TCPSenderTestHarness( std::string name, TCPConfig config )
     : TestHarness( move( name ),
                    "initial_RTO_ms=" + to_string( config.rt_timeout ),
-                   { ByteStream { config.send_capacity }, TCPSender { config.rt_timeout, config.fixed_isn } } )
+                   { ByteStream { config.send_capacity }, TCPSender { config } } )
   {}
 };
@@ -0,0 +1,94 @@
+#include "allocation_counter.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+static void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( "autotuned TCPPeer: " + what );
+  }
+}
+
+// Deliver segments between the peers until neither has anything more to send, reading whatever the server
+// receives as it arrives
+static void exchange( TCPPeer& client, TCPPeer& server, string& received )
+{
+  bool sent = true;
+  while ( sent ) {
+    sent = false;
+    while ( auto seg = client.maybe_send() ) {
+      server.receive( move( seg.value() ) );
+      sent = true;
+    }
+    while ( auto seg = server.maybe_send() ) {
+      client.receive( move( seg.value() ) );
+      sent = true;
+    }
+    Reader& reader = server.inbound_reader();
+    while ( reader.bytes_buffered() > 0 ) {
+      received += reader.peek();
+      reader.pop( reader.peek().size() );
+    }
+  }
+}
+
+int main()
+{
+  try {
+    TCPConfig cfg;
+    cfg.autotune_capacity = true;
+
+    const size_t before_peers = allocated_bytes;
+    TCPPeer client { cfg };
+    TCPPeer server { cfg };
+    // four 4 KB streams, plus a little for everything else
+    expect( allocated_bytes - before_peers < 4 * TCPConfig::AUTOTUNE_INITIAL_CAPACITY + 8192,
+            "a new pair of peers holds " + to_string( allocated_bytes - before_peers ) + " bytes" );
+
+    client.push();
+    string received;
+    exchange( client, server, received );
+    expect( server.inbound_reader().bytes_popped() == 0 and client.sender().sequence_numbers_in_flight() == 0,
+            "handshake" );
+
+    // the application writes faster than the window drains the outbound stream, which grows to hold it
+    string data( 40000, 0 );
+    for ( size_t i = 0; i < data.size(); ++i ) {
+      data[i] = static_cast<char>( 'a' + i % 26 );
+    }
+    received.reserve( data.size() );
+    const size_t before_write = allocated_bytes;
+    client.outbound_writer().push( data );
+    expect( client.outbound_writer().bytes_pushed() == data.size(), "the outbound stream grew to take the write" );
+    const size_t grown = allocated_bytes - before_write;
+    expect( grown >= data.size(), "the grown outbound stream holds only " + to_string( grown ) + " more bytes" );
+
+    exchange( client, server, received );
+    expect( received == data, "the server received what the client wrote" );
+
+    // once the outbound stream has been idle for a while, its memory goes back
+    const size_t before_idle = allocated_bytes;
+    client.tick( 1 );
+    client.tick( TCPConfig::AUTOTUNE_IDLE_MS );
+    const size_t freed = before_idle - allocated_bytes;
+    expect( allocated_bytes <= before_idle and freed + TCPConfig::AUTOTUNE_INITIAL_CAPACITY >= grown,
+            "an idle outbound stream gave back " + to_string( freed ) + " of " + to_string( grown ) + " bytes" );
+    expect( client.outbound_writer().available_capacity() == TCPConfig::AUTOTUNE_INITIAL_CAPACITY,
+            "the idle outbound stream is back to its initial capacity" );
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,93 @@
+#include "conversions.hh"
+#include "random.hh"
+#include "wrapping_integers_reference.hh"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+// unwrap is usable at compile time
+static_assert( Wrap32 { 1 }.unwrap( Wrap32 { 0 }, 0 ) == 1 );
+static_assert( Wrap32 { 1 }.unwrap( Wrap32 { 0 }, UINT32_MAX ) == ( 1UL << 32 ) + 1 );
+static_assert( Wrap32 { UINT32_MAX }.unwrap( Wrap32 { 10 }, 3 * ( 1UL << 32 ) ) == 3 * ( 1UL << 32 ) - 11 );
+static_assert( Wrap32::wrap( 3 * ( 1UL << 32 ), Wrap32 { 17 } ) == Wrap32 { 17 } );
+
+void check_against_reference( const Wrap32 value, const Wrap32 zero_point, const uint64_t checkpoint )
+{
+  const uint64_t expected = ReferenceWrap32 { value }.unwrap( zero_point, checkpoint );
+  const uint64_t actual = value.unwrap( zero_point, checkpoint );
+  if ( actual != expected ) {
+    ostringstream ss;
+    ss << "unwrap(" << value << ", zero_point=" << zero_point << ", checkpoint=" << checkpoint << ") returned "
+       << actual << ", but the reference implementation returned " << expected << ".\n";
+    throw runtime_error( ss.str() );
+  }
+}
+
+int main()
+{
+  try {
+    // every combination of values near the places where wrapping, rounding or tie-breaking changes
+    const vector<uint32_t> edges32 { 0,
+                                     1,
+                                     2,
+                                     ( 1U << 31 ) - 2,
+                                     ( 1U << 31 ) - 1,
+                                     1U << 31,
+                                     ( 1U << 31 ) + 1,
+                                     ( 1U << 31 ) + 2,
+                                     UINT32_MAX - 1,
+                                     UINT32_MAX };
+    vector<uint64_t> checkpoints;
+    for ( const uint64_t round : { 0UL, 1UL, 2UL, 1UL << 20, ( 1UL << 31 ) - 1 } ) {
+      for ( const uint32_t low : edges32 ) {
+        checkpoints.push_back( ( round << 32 ) + low );
+      }
+    }
+
+    for ( const uint32_t value : edges32 ) {
+      for ( const uint32_t zero_point : edges32 ) {
+        for ( const uint64_t checkpoint : checkpoints ) {
+          check_against_reference( Wrap32 { value }, Wrap32 { zero_point }, checkpoint );
+          check_against_reference( Wrap32 { value + zero_point }, Wrap32 { zero_point }, checkpoint );
+        }
+      }
+    }
+
+    // and random ones
+    auto rd = get_random_engine();
+    uniform_int_distribution<uint32_t> dist32 { 0, UINT32_MAX };
+    uniform_int_distribution<uint64_t> dist63 { 0, ( 1UL << 63 ) - 1 };
+    for ( unsigned int i = 0; i < 1000000; i++ ) {
+      check_against_reference( Wrap32 { dist32( rd ) }, Wrap32 { dist32( rd ) }, dist63( rd ) );
+      check_against_reference( Wrap32 { dist32( rd ) }, Wrap32 { dist32( rd ) }, dist32( rd ) );
+    }
+
+    // unwrap_batch agrees with unwrap, element by element
+    for ( unsigned int i = 0; i < 1000; i++ ) {
+      const Wrap32 zero_point { dist32( rd ) };
+      const uint64_t checkpoint = i % 2 ? dist63( rd ) : dist32( rd );
+      vector<Wrap32> seqnos;
+      for ( unsigned int j = 0; j < i % 67; j++ ) {
+        seqnos.emplace_back( dist32( rd ) );
+      }
+      vector<uint64_t> out( seqnos.size() );
+      Wrap32::unwrap_batch( seqnos, zero_point, checkpoint, out );
+      for ( size_t j = 0; j < seqnos.size(); j++ ) {
+        if ( out[j] != seqnos[j].unwrap( zero_point, checkpoint ) ) {
+          throw runtime_error( "unwrap_batch disagreed with unwrap" );
+        }
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
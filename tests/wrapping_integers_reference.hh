@@ -0,0 +1,41 @@
+#pragma once
+
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+
+// The original candidate-comparing unwrap, kept to check the constant-time version against
+class ReferenceWrap32 : public Wrap32
+{
+  static constexpr uint64_t MOD = 1UL << 32;
+
+  static uint64_t sub_abs( uint64_t a, uint64_t b ) { return b > a ? b - a : a - b; }
+
+public:
+  explicit ReferenceWrap32( Wrap32 w ) : Wrap32( w ) {}
+
+  uint64_t unwrap( Wrap32 zero_point, uint64_t checkpoint ) const
+  {
+    const uint32_t zero = ReferenceWrap32 { zero_point }.raw_value_;
+    const uint64_t round = checkpoint / MOD;
+
+    uint64_t val = 0;
+    if ( raw_value_ < zero ) {
+      val = MOD - zero + raw_value_;
+    } else {
+      val = raw_value_ - zero;
+    }
+    const uint64_t v1 = ( ( round >= 1UL ) ? ( round - 1 ) : 0 ) * MOD + val;
+    const uint64_t v2 = round * MOD + val;
+    const uint64_t v3 = ( round + 1 ) * MOD + val;
+    if ( sub_abs( v1, checkpoint ) <= sub_abs( v2, checkpoint )
+         && sub_abs( v1, checkpoint ) <= sub_abs( v3, checkpoint ) ) {
+      return v1;
+    }
+    if ( sub_abs( v2, checkpoint ) <= sub_abs( v1, checkpoint )
+         && sub_abs( v2, checkpoint ) <= sub_abs( v3, checkpoint ) ) {
+      return v2;
+    }
+    return v3;
+  }
+};
@@ -0,0 +1,92 @@
+#include "wrapping_integers_reference.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+template<typename Unwrapper>
+double ns_per_unwrap( const vector<Wrap32>& seqnos, const Wrap32 zero_point, Unwrapper&& unwrap )
+{
+  // each checkpoint depends on the previous answer, as in a receiver following the stream
+  uint64_t checkpoint = 0;
+  const auto start_time = steady_clock::now();
+  for ( const auto seqno : seqnos ) {
+    checkpoint = unwrap( seqno, zero_point, checkpoint );
+  }
+  const auto stop_time = steady_clock::now();
+
+  if ( checkpoint == 0 ) {
+    throw runtime_error( "unwrap never moved past zero" );
+  }
+  return duration_cast<duration<double, nano>>( stop_time - start_time ).count()
+         / static_cast<double>( seqnos.size() );
+}
+
+void speed_test( const size_t num_seqnos, const size_t random_seed )
+{
+  // a stream moving forward in irregular steps, so that it wraps many times
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<uint32_t> step { 0, 1U << 30 };
+  const Wrap32 zero_point { static_cast<uint32_t>( rd() ) };
+  vector<Wrap32> seqnos;
+  seqnos.reserve( num_seqnos );
+  uint64_t absolute = 0;
+  for ( size_t i = 0; i < num_seqnos; ++i ) {
+    absolute += step( rd );
+    seqnos.push_back( Wrap32::wrap( absolute, zero_point ) );
+  }
+
+  const double fast = ns_per_unwrap( seqnos, zero_point, []( Wrap32 seqno, Wrap32 zero, uint64_t checkpoint ) {
+    return seqno.unwrap( zero, checkpoint );
+  } );
+  const double reference
+    = ns_per_unwrap( seqnos, zero_point, []( Wrap32 seqno, Wrap32 zero, uint64_t checkpoint ) {
+        return ReferenceWrap32 { seqno }.unwrap( zero, checkpoint );
+      } );
+
+  // unwrapping a window of sequence numbers at a time against one checkpoint, as a sender with a deep queue might
+  constexpr size_t window = 1024;
+  vector<uint64_t> out( window );
+  uint64_t total = 0;
+  const auto batch_start = steady_clock::now();
+  for ( size_t i = 0; i + window <= seqnos.size(); i += window ) {
+    Wrap32::unwrap_batch( span { seqnos }.subspan( i, window ), zero_point, total, out );
+    total = out.back();
+  }
+  const auto batch_stop = steady_clock::now();
+  if ( total != seqnos[seqnos.size() / window * window - 1].unwrap( zero_point, total ) ) {
+    throw runtime_error( "unwrap_batch disagreed with unwrap" );
+  }
+  const double batch = duration_cast<duration<double, nano>>( batch_stop - batch_start ).count()
+                       / static_cast<double>( seqnos.size() / window * window );
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "Wrap32::unwrap took " << fixed << setprecision( 2 ) << fast << " ns (reference implementation: "
+       << reference << " ns).\n";
+  cout << "Wrap32::unwrap_batch took " << fixed << setprecision( 2 ) << batch << " ns per sequence number.\n";
+
+  debug_output << "                     Wrap32::unwrap: " << fixed << setprecision( 2 ) << fast << " ns\n";
+}
+
+int main()
+{
+  try {
+    speed_test( 1e7, 4321 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -1,23 +1,75 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <string_view>
 
+// A reference-counted (possibly partial) view of an immutable string.
+// Copies and substr() share the underlying storage; mutable access to a slice first copies it out.
+// An empty Buffer allocates nothing until mutable access needs a string.
 class Buffer
 {
-  std::shared_ptr<std::string> buffer_;
+  std::shared_ptr<std::string> buffer_ {}; // null: empty
+  size_t offset_ {};
+  size_t length_ { std::string::npos }; // npos: the whole string, whatever its current size
+
+  bool is_slice() const { return length_ != std::string::npos; }
+
+  void materialize()
+  {
+    if ( is_slice() or not buffer_ ) {
+      buffer_ = std::make_shared<std::string>( std::string_view( *this ) );
+      offset_ = 0;
+      length_ = std::string::npos;
+    }
+  }
 
 public:
   // NOLINTBEGIN(*-explicit-*)
 
-  Buffer( std::string str = {} ) : buffer_( make_shared<std::string>( std::move( str ) ) ) {}
-  operator std::string_view() const { return *buffer_; }
-  operator std::string&() { return *buffer_; }
+  Buffer() = default;
+  Buffer( std::string str ) : buffer_( make_shared<std::string>( std::move( str ) ) ) {}
+  Buffer( std::shared_ptr<std::string> str ) : buffer_( std::move( str ) ) {}
+  operator std::string_view() const
+  {
+    if ( not buffer_ ) {
+      return {};
+    }
+    return is_slice() ? std::string_view( *buffer_ ).substr( offset_, length_ ) : std::string_view( *buffer_ );
+  }
+  operator std::string&()
+  {
+    materialize();
+    return *buffer_;
+  }
 
   // NOLINTEND(*-explicit-*)
 
-  std::string&& release() { return std::move( *buffer_ ); }
-  size_t size() const { return buffer_->size(); }
-  size_t length() const { return buffer_->length(); }
-  bool empty() const { return buffer_->empty(); }
+  std::string&& release()
+  {
+    materialize();
+    return std::move( *buffer_ );
+  }
+  size_t size() const
+  {
+    if ( is_slice() ) {
+      return length_;
+    }
+    return buffer_ ? buffer_->size() : 0;
+  }
+  size_t length() const { return size(); }
+  bool empty() const { return size() == 0; }
+
+  // Bytes allocated for the underlying storage, which may be shared with other Buffers
+  size_t storage_size() const { return buffer_ ? buffer_->capacity() : 0; }
+
+  // A Buffer sharing this one's storage, holding at most `len` bytes starting at `pos`
+  Buffer substr( size_t pos, size_t len = std::string::npos ) const
+  {
+    Buffer ret { *this };
+    ret.offset_ += pos;
+    ret.length_ = std::min( len, size() - pos );
+    return ret;
+  }
 };
@@ -3,6 +3,7 @@
 #include "exception.hh"
 
 #include <algorithm>
+#include <climits>
 #include <fcntl.h>
 #include <iostream>
 #include <stdexcept>
@@ -150,6 +151,31 @@ void FileDescriptor::read( vector<string>& buffers )
   }
 }
 
+size_t FileDescriptor::read( const vector<span<char>>& buffers )
+{
+  vector<iovec> iovecs;
+  iovecs.reserve( buffers.size() );
+  for ( const auto x : buffers ) {
+    iovecs.push_back( { x.data(), x.size() } );
+  }
+
+  const ssize_t bytes_read = ::readv( fd_num(), iovecs.data(), static_cast<int>( iovecs.size() ) );
+  if ( bytes_read < 0 ) {
+    if ( internal_fd_->non_blocking_ and ( errno == EAGAIN or errno == EINPROGRESS ) ) {
+      return 0;
+    }
+    throw unix_error { "read" };
+  }
+
+  register_read();
+
+  if ( bytes_read == 0 ) {
+    internal_fd_->eof_ = true;
+  }
+
+  return bytes_read;
+}
+
 size_t FileDescriptor::write( string_view buffer )
 {
   return write( vector<string_view> { buffer } );
@@ -167,10 +193,14 @@ size_t FileDescriptor::write( const vector<Buffer>& buffers )
 
 size_t FileDescriptor::write( const vector<string_view>& buffers )
 {
+  // writev() accepts at most IOV_MAX buffers; any beyond that are left for the caller's next write
   vector<iovec> iovecs;
-  iovecs.reserve( buffers.size() );
+  iovecs.reserve( min( buffers.size(), static_cast<size_t>( IOV_MAX ) ) );
   size_t total_size = 0;
   for ( const auto x : buffers ) {
+    if ( iovecs.size() == IOV_MAX ) {
+      break;
+    }
     iovecs.push_back( { const_cast<char*>( x.data() ), x.size() } ); // NOLINT(*-const-cast)
     total_size += x.size();
   }
@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <span>
 #include <vector>
 
 // A reference-counted handle to a file descriptor
@@ -66,6 +67,10 @@ public:
   void read( std::string& buffer );
   void read( std::vector<std::string>& buffers );
 
+  // Read into caller-owned memory, filling `buffers` in order
+  // returns number of bytes read (0 at EOF, or if a non-blocking read would block)
+  size_t read( const std::vector<std::span<char>>& buffers );
+
   // Attempt to write a buffer
   // returns number of bytes written
   size_t write( std::string_view buffer );
@@ -0,0 +1,130 @@
+#include "ring_memory.hh"
+
+#include "exception.hh"
+#include "file_descriptor.hh"
+
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+static size_t round_up_to_pages( size_t size )
+{
+  const auto page_size = static_cast<size_t>( CheckSystemCall( "sysconf", sysconf( _SC_PAGESIZE ) ) );
+  return ( size + page_size - 1 ) / page_size * page_size;
+}
+
+static char* check_mmap( string_view s_attempt, void* addr )
+{
+  if ( addr == MAP_FAILED ) {
+    throw unix_error { s_attempt };
+  }
+  return static_cast<char*>( addr );
+}
+
+RingMemory::RingMemory( size_t min_size, Policy policy )
+  : policy_( policy ), size_( policy == Policy::Heap ? min_size : round_up_to_pages( min_size ) )
+{
+  allocate();
+}
+
+RingMemory::~RingMemory()
+{
+  release();
+}
+
+RingMemory::RingMemory( const RingMemory& other ) : policy_( other.policy_ ), size_( other.size_ )
+{
+  allocate();
+  if ( size_ > 0 ) {
+    memcpy( data_, other.data_, size_ );
+  }
+}
+
+RingMemory& RingMemory::operator=( const RingMemory& other )
+{
+  if ( this != &other ) {
+    RingMemory copy { other };
+    *this = move( copy );
+  }
+  return *this;
+}
+
+RingMemory::RingMemory( RingMemory&& other ) noexcept
+  : policy_( other.policy_ ), size_( exchange( other.size_, 0 ) ), data_( exchange( other.data_, nullptr ) )
+{}
+
+RingMemory& RingMemory::operator=( RingMemory&& other ) noexcept
+{
+  if ( this != &other ) {
+    release();
+    policy_ = other.policy_;
+    size_ = exchange( other.size_, 0 );
+    data_ = exchange( other.data_, nullptr );
+  }
+  return *this;
+}
+
+void RingMemory::allocate()
+{
+  if ( size_ == 0 ) {
+    return;
+  }
+
+  switch ( policy_ ) {
+    case Policy::Heap:
+      data_ = new char[size_]();
+      break;
+
+    case Policy::Mapped:
+    case Policy::HugePages:
+      data_ = check_mmap( "mmap",
+                          mmap( nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 ) );
+      if ( policy_ == Policy::HugePages ) {
+        madvise( data_, size_, MADV_HUGEPAGE ); // only a hint; kernels without THP just say no
+      }
+      break;
+
+    case Policy::Mirrored: {
+      // reserve twice the address space, then map one memory file over both halves
+      const FileDescriptor memory { CheckSystemCall( "memfd_create", memfd_create( "RingMemory", MFD_CLOEXEC ) ) };
+      CheckSystemCall( "ftruncate", ftruncate( memory.fd_num(), static_cast<off_t>( size_ ) ) );
+      char* region = check_mmap(
+        "mmap", mmap( nullptr, 2 * size_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 ) );
+      for ( char* half : { region, region + size_ } ) {
+        if ( mmap( half, size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, memory.fd_num(), 0 ) == MAP_FAILED ) {
+          const unix_error error { "mmap" };
+          munmap( region, 2 * size_ );
+          throw error;
+        }
+      }
+      data_ = region;
+      break;
+    }
+  }
+}
+
+void RingMemory::release()
+{
+  if ( data_ == nullptr ) {
+    return;
+  }
+
+  switch ( policy_ ) {
+    case Policy::Heap:
+      delete[] data_;
+      break;
+
+    case Policy::Mapped:
+    case Policy::HugePages:
+      munmap( data_, size_ );
+      break;
+
+    case Policy::Mirrored:
+      munmap( data_, 2 * size_ );
+      break;
+  }
+  data_ = nullptr;
+}
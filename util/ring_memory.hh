@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+// Backing memory for a ring buffer, obtained according to an allocation policy
+class RingMemory
+{
+public:
+  enum class Policy
+  {
+    Heap,      // plain operator new[]
+    Mapped,    // page-aligned anonymous mmap(2)
+    HugePages, // Mapped, and advised (best effort) to use transparent huge pages
+    Mirrored   // the same pages mapped twice back to back: data()[i + size()] is data()[i]
+  };
+
+private:
+  Policy policy_;
+  size_t size_;
+  char* data_ {};
+
+  void allocate();
+  void release();
+
+public:
+  // Allocate at least `min_size` bytes (rounded up to whole pages for the mmap-based policies)
+  RingMemory( size_t min_size, Policy policy );
+  ~RingMemory();
+
+  // Copies get their own memory with the same policy, size and contents
+  RingMemory( const RingMemory& other );
+  RingMemory& operator=( const RingMemory& other );
+  RingMemory( RingMemory&& other ) noexcept;
+  RingMemory& operator=( RingMemory&& other ) noexcept;
+
+  char* data() { return data_; }
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  // How many bytes can be addressed contiguously from offset `pos` (< size()) without wrapping?
+  size_t contiguous( size_t pos ) const { return policy_ == Policy::Mirrored ? size_ : size_ - pos; }
+};
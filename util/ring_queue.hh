@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// A FIFO queue with random access, kept in a ring of slots that are reused rather than freed.
+// Once it has grown to its working size, pushing and popping allocate nothing.
+template<typename T>
+class RingQueue
+{
+  std::vector<T> slots_ {}; // the number of slots is zero or a power of two
+  size_t head_ {};
+  size_t size_ {};
+
+  size_t slot( size_t i ) const { return ( head_ + i ) & ( slots_.size() - 1 ); }
+
+  void grow()
+  {
+    std::vector<T> slots( slots_.empty() ? 8 : 2 * slots_.size() );
+    for ( size_t i = 0; i < size_; ++i ) {
+      slots[i] = std::move( slots_[slot( i )] );
+    }
+    slots_ = std::move( slots );
+    head_ = 0;
+  }
+
+public:
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+  T& operator[]( size_t i ) { return slots_[slot( i )]; }
+  const T& operator[]( size_t i ) const { return slots_[slot( i )]; }
+  T& front() { return ( *this )[0]; }
+  const T& front() const { return ( *this )[0]; }
+  T& back() { return ( *this )[size_ - 1]; }
+  const T& back() const { return ( *this )[size_ - 1]; }
+
+  // Append an element, overwriting whatever the slot it lands in held
+  T& push_back( T value )
+  {
+    if ( size_ == slots_.size() ) {
+      grow();
+    }
+    T& slot_value = slots_[slot( size_++ )];
+    slot_value = std::move( value );
+    return slot_value;
+  }
+
+  // Remove the first element, resetting its slot so it holds on to nothing
+  void pop_front()
+  {
+    slots_[head_] = T {};
+    head_ = slot( 1 );
+    --size_;
+  }
+};
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "address.hh"
+#include "congestion_control.hh"
+#include "rtt_estimator.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
@@ -11,14 +13,31 @@
 class TCPConfig
 {
 public:
-  static constexpr size_t DEFAULT_CAPACITY = 64000; //!< Default capacity
-  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative max payload size for real Internet
-  static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
-  static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
+  static constexpr size_t DEFAULT_CAPACITY = 64000;         //!< Default capacity
+  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;          //!< Conservative max payload size for real Internet
+  static constexpr size_t MAX_SUPER_SEGMENT_SIZE = 64000;   //!< Largest payload of a super-segment (fits in IPv4)
+  static constexpr uint16_t TIMEOUT_DFLT = 1000;            //!< Default re-transmit timeout is 1 second
+  static constexpr unsigned MAX_RETX_ATTEMPTS = 8;          //!< Maximum re-transmit attempts before giving up
+  static constexpr size_t AUTOTUNE_INITIAL_CAPACITY = 4096; //!< Starting capacity of autotuned streams
+  static constexpr uint64_t AUTOTUNE_IDLE_MS = 1000;        //!< Idle time before an autotuned send stream shrinks
 
   uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
   size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
   size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
+  bool autotune_capacity = false;          //!< Start streams small and grow them up to recv/send_capacity
+  bool sack = true;                        //!< Offer and send selective acknowledgments (RFC 2018)
+  bool fast_retransmit = false;            //!< Resend after three duplicate acks, recovering as NewReno does
+  bool pacing = false;                     //!< Spread segments out at the pacing rate instead of in bursts
+  uint16_t mss = MAX_PAYLOAD_SIZE;         //!< Largest payload to send or receive in a datagram (sent in the SYN)
+  bool super_segments = false;             //!< Make segments of many MSS, split into datagrams by the adapter
+
+  //! Congestion controller consulted by the sender (None: limited only by the receiver's window)
+  CongestionControl congestion_control = CongestionControl::None;
+
+  //! Adapt the retransmission timeout to the measured round-trip time (RFC 6298), within these bounds
+  //! (nullopt: every ack resets it to rt_timeout)
+  std::optional<RTOBounds> adaptive_rto {};
+
   std::optional<Wrap32> fixed_isn {};
 };
 
@@ -5,6 +5,7 @@
 #include "parser.hh"
 #include "tun.hh"
 
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <iostream>
@@ -33,7 +34,9 @@ void TCPMinnowSocket<AdaptT>::_tcp_loop( const function<bool()>& condition )
 {
   auto base_time = timestamp_ms();
   while ( condition() ) {
-    auto ret = _eventloop.wait_next_event( TCP_TICK_MS );
+    // wake up early if a paced segment will be ready before the next tick
+    const auto next_send = _tcp.has_value() ? _tcp->next_send_time() : nullopt;
+    auto ret = _eventloop.wait_next_event( min( TCP_TICK_MS, next_send.value_or( TCP_TICK_MS ) ) );
     if ( ret == EventLoop::Result::Exit or _abort ) {
       break;
     }
@@ -114,10 +117,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     _thread_data,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _tcp->outbound_writer().available_capacity() );
-      _thread_data.read( data );
-      _tcp->outbound_writer().push( move( data ) );
+      read_into( _thread_data, _tcp->outbound_writer() );
 
       if ( _thread_data.eof() ) {
         _tcp->outbound_writer().close();
@@ -152,8 +152,7 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
       // the pipe, handling the possibility of a partial
       // write (i.e., only pop what was actually written).
       if ( inbound.bytes_buffered() ) {
-        const std::string_view buffer = inbound.peek();
-        const auto bytes_written = _thread_data.write( buffer );
+        const auto bytes_written = _thread_data.write( inbound.peek_iovecs() );
         inbound.pop( bytes_written );
       }
 
@@ -72,19 +72,14 @@ optional<TCPSegment> TCPOverIPv4Adapter::unwrap_tcp_in_ip( const InternetDatagra
   return tcp_seg;
 }
 
-//! Takes a TCP segment, sets port numbers as necessary, and wraps it in an IPv4 datagram
-//! \param[in] seg is the TCP segment to convert
-InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip( TCPSegment& seg )
+// wrap one TCP segment (with its port numbers set) in an IPv4 datagram
+static InternetDatagram wrap_segment( TCPSegment& seg, uint32_t src, uint32_t dst )
 {
-  // set the port numbers in the TCP segment
-  seg.udinfo.src_port = config().source.port();
-  seg.udinfo.dst_port = config().destination.port();
-
   // create an Internet Datagram and set its addresses and length
   InternetDatagram ip_dgram;
-  ip_dgram.header.src = config().source.ipv4_numeric();
-  ip_dgram.header.dst = config().destination.ipv4_numeric();
-  ip_dgram.header.len = ip_dgram.header.hlen * 4 + 20 /* tcp header len */ + seg.sender_message.payload.size();
+  ip_dgram.header.src = src;
+  ip_dgram.header.dst = dst;
+  ip_dgram.header.len = ip_dgram.header.hlen * 4 + seg.header_length() + seg.sender_message.payload.size();
 
   // set payload, calculating TCP checksum using information from IP header
   seg.compute_checksum( ip_dgram.header.pseudo_checksum() );
@@ -93,3 +88,36 @@ InternetDatagram TCPOverIPv4Adapter::wrap_tcp_in_ip( TCPSegment& seg )
 
   return ip_dgram;
 }
+
+//! Takes a TCP segment, sets port numbers as necessary, and wraps it in IPv4 datagrams.
+//! \details A super-segment (one whose payload is longer than its split_size) is cut into segments of
+//! split_size bytes of payload, each in its own datagram. The SYN goes with the first and the FIN with the last.
+//! \param[in] seg is the TCP segment to convert
+vector<InternetDatagram> TCPOverIPv4Adapter::wrap_tcp_in_ip( TCPSegment& seg )
+{
+  // set the port numbers in the TCP segment
+  seg.udinfo.src_port = config().source.port();
+  seg.udinfo.dst_port = config().destination.port();
+
+  const uint32_t src = config().source.ipv4_numeric();
+  const uint32_t dst = config().destination.ipv4_numeric();
+  const TCPSenderMessage& msg = seg.sender_message;
+  const size_t payload_size = msg.payload.size();
+
+  vector<InternetDatagram> datagrams;
+  if ( seg.split_size == 0 or payload_size <= seg.split_size ) {
+    datagrams.push_back( wrap_segment( seg, src, dst ) );
+    return datagrams;
+  }
+
+  datagrams.reserve( ( payload_size + seg.split_size - 1 ) / seg.split_size );
+  for ( size_t offset = 0; offset < payload_size; offset += seg.split_size ) {
+    TCPSegment piece { seg };
+    piece.sender_message.seqno = offset == 0 ? msg.seqno : msg.seqno + static_cast<uint32_t>( msg.SYN + offset );
+    piece.sender_message.SYN = msg.SYN and offset == 0;
+    piece.sender_message.payload = msg.payload.substr( offset, seg.split_size );
+    piece.sender_message.FIN = msg.FIN and offset + seg.split_size >= payload_size;
+    datagrams.push_back( wrap_segment( piece, src, dst ) );
+  }
+  return datagrams;
+}
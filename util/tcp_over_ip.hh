@@ -6,6 +6,7 @@
 #include "tcp_segment.hh"
 
 #include <optional>
+#include <vector>
 
 //! \brief A converter from TCP segments to serialized IPv4 datagrams
 class TCPOverIPv4Adapter : public FdAdapterBase
@@ -13,5 +14,5 @@ class TCPOverIPv4Adapter : public FdAdapterBase
 public:
   std::optional<TCPSegment> unwrap_tcp_in_ip( const InternetDatagram& ip_dgram );
 
-  InternetDatagram wrap_tcp_in_ip( TCPSegment& seg );
+  std::vector<InternetDatagram> wrap_tcp_in_ip( TCPSegment& seg );
 };
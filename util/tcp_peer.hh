@@ -7,18 +7,56 @@
 #include "tcp_sender.hh"
 #include "tcp_sender_message.hh"
 
+#include <algorithm>
 #include <optional>
 
 class TCPPeer
 {
   TCPConfig cfg_;
-  TCPSender sender_ { cfg_.rt_timeout, cfg_.fixed_isn };
+  TCPSender sender_ { cfg_ };
   TCPReceiver receiver_ {};
   Reassembler reassembler_ {};
 
-  ByteStream outbound_stream_ { cfg_.send_capacity }, inbound_stream_ { cfg_.recv_capacity };
+  ByteStream outbound_stream_ { initial_capacity( cfg_.send_capacity ), cfg_.send_capacity, storage() },
+    inbound_stream_ { initial_capacity( cfg_.recv_capacity ), cfg_.recv_capacity, storage() };
 
   bool need_send_ {};
+  bool peer_sack_permitted_ {}; // the peer's SYN offered to take SACK blocks
+
+  uint64_t bytes_moved_ {};
+  uint64_t idle_ms_ {};
+
+  uint64_t initial_capacity( uint64_t capacity ) const
+  {
+    return cfg_.autotune_capacity ? std::min( capacity, TCPConfig::AUTOTUNE_INITIAL_CAPACITY ) : capacity;
+  }
+
+  // Autotuned streams are rings, whose memory is reallocated to follow their capacity. Otherwise the streams
+  // are chunked, holding only the bytes buffered, and segments share the chunks instead of copying them.
+  ByteStream::Storage storage() const
+  {
+    return cfg_.autotune_capacity ? ByteStream::Storage::Ring : ByteStream::Storage::Chunked;
+  }
+
+  // An autotuned outbound stream that has carried no bytes for a while gives its extra memory back.
+  // The inbound stream keeps its capacity: it is the receive window already advertised to the peer, which
+  // must not shrink (RFC 9293), or data the peer was told it could send would be dropped.
+  void shrink_idle_outbound_stream( uint64_t ms_since_last_tick )
+  {
+    const uint64_t bytes_moved
+      = outbound_stream_.writer().bytes_pushed() + outbound_stream_.reader().bytes_popped();
+    if ( bytes_moved != bytes_moved_ ) {
+      bytes_moved_ = bytes_moved;
+      idle_ms_ = 0;
+      return;
+    }
+
+    idle_ms_ += ms_since_last_tick;
+    if ( idle_ms_ >= TCPConfig::AUTOTUNE_IDLE_MS ) {
+      outbound_stream_.shrink_if_empty();
+      idle_ms_ = 0;
+    }
+  }
 
 public:
   explicit TCPPeer( const TCPConfig& cfg ) : cfg_( cfg ) {}
@@ -27,7 +65,14 @@ public:
   Reader& inbound_reader() { return inbound_stream_.reader(); }
 
   void push() { sender_.push( outbound_stream_.reader() ); };
-  void tick( uint64_t ms_since_last_tick ) { sender_.tick( ms_since_last_tick ); }
+  void tick( uint64_t ms_since_last_tick )
+  {
+    sender_.tick( ms_since_last_tick );
+    shrink_idle_outbound_stream( ms_since_last_tick );
+  }
+
+  // Milliseconds until the sender has a (paced) segment ready, if any is waiting
+  std::optional<uint64_t> next_send_time() const { return sender_.next_send_time(); }
 
   bool has_ackno() const { return receiver_.send( inbound_stream_.writer() ).ackno.has_value(); }
 
@@ -47,6 +92,13 @@ public:
       return;
     }
 
+    if ( seg.sender_message.SYN ) {
+      peer_sack_permitted_ = seg.sack_permitted;
+      if ( seg.mss.value_or( 0 ) > 0 ) {
+        sender_.set_MSS( std::min( cfg_.mss, seg.mss.value() ) );
+      }
+    }
+
     // Give incoming TCPReceiverMessage to sender.
     sender_.receive( seg.receiver_message );
 
@@ -61,8 +113,10 @@ public:
 
   std::optional<TCPSegment> maybe_send()
   {
-    // Get outgoing TCPReceiverMessage from receiver.
-    auto receiver_msg = receiver_.send( inbound_stream_.writer() );
+    // Get outgoing TCPReceiverMessage from receiver, with SACK blocks if both sides agreed to them.
+    auto receiver_msg = cfg_.sack and peer_sack_permitted_
+                          ? receiver_.send( inbound_stream_.writer(), reassembler_ )
+                          : receiver_.send( inbound_stream_.writer() );
 
     // If connection is alive, push stream to TCPSender.
     if ( receiver_msg.ackno.has_value() ) {
@@ -78,10 +132,15 @@ public:
 
     need_send_ = false;
 
-    // Send the segment
+    // Send the segment (a super-segment is split into MSS-sized segments by the adapter)
     if ( sender_msg.has_value() ) {
-      return TCPSegment {
-        sender_msg.value(), receiver_msg, outbound_stream_.reader().has_error() or inbound_reader().has_error() };
+      return TCPSegment { sender_msg.value(),
+                          receiver_msg,
+                          outbound_stream_.reader().has_error() or inbound_reader().has_error(),
+                          {},
+                          cfg_.sack,
+                          cfg_.mss,
+                          cfg_.super_segments ? static_cast<uint16_t>( sender_.MSS() ) : uint16_t {} };
     }
 
     return {};
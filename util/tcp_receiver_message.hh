@@ -3,11 +3,12 @@
 #include "wrapping_integers.hh"
 
 #include <optional>
+#include <vector>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
  *
- * It contains two fields:
+ * It contains three fields:
  *
  * 1) The acknowledgment number (ackno): the *next* sequence number needed by the TCP Receiver.
  *    This is an optional field that is empty if the TCPReceiver hasn't yet received the Initial Sequence Number.
@@ -15,10 +16,24 @@
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
  *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
  *    the <cstdint> header).
+ *
+ * 3) Selective acknowledgment (SACK) blocks: ranges of sequence numbers beyond the ackno that the TCP
+ *    Receiver already holds (RFC 2018), lowest first. At most MAX_SACK_BLOCKS fit in the TCP header
+ *    (fewer beside a SYN's options).
  */
 
+// A range of received sequence numbers, from `left` up to (but not including) `right`
+struct SACKBlock
+{
+  Wrap32 left;
+  Wrap32 right;
+};
+
 struct TCPReceiverMessage
 {
+  static constexpr size_t MAX_SACK_BLOCKS = 4;
+
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
+  std::vector<SACKBlock> sack_blocks {};
 };
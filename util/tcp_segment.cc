@@ -2,12 +2,68 @@
 #include "checksum.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <cstddef>
 
 static constexpr uint32_t TCPHeaderMinLen = 5; // 32-bit words
+static constexpr size_t TCPMaxOptionsLen = 40; // bytes: the data offset can't exceed 15 words
+
+// TCP option kinds
+static constexpr uint8_t TCPOptionEnd = 0;
+static constexpr uint8_t TCPOptionNop = 1;
+static constexpr uint8_t TCPOptionMSS = 2;
+static constexpr uint8_t TCPOptionSACKPermitted = 4;
+static constexpr uint8_t TCPOptionSACK = 5;
+static constexpr uint8_t SACKBlockLen = 8;
 
 using namespace std;
 
+// read the MSS and SACK-related options, and skip any others
+static void parse_options( Parser& parser, uint32_t options_len, TCPSegment& seg )
+{
+  while ( options_len > 0 and not parser.has_error() ) {
+    uint8_t kind {};
+    parser.integer( kind );
+    options_len--;
+    if ( kind == TCPOptionEnd ) {
+      break;
+    }
+    if ( kind == TCPOptionNop ) {
+      continue;
+    }
+
+    uint8_t len {};
+    parser.integer( len );
+    if ( len < 2 or len - 1U > options_len ) {
+      parser.set_error();
+      return;
+    }
+    options_len -= len - 1;
+    uint32_t body_len = len - 2;
+
+    if ( kind == TCPOptionMSS and body_len == 2 ) {
+      uint16_t mss {};
+      parser.integer( mss );
+      seg.mss = mss;
+      body_len = 0;
+    } else if ( kind == TCPOptionSACKPermitted ) {
+      seg.sack_permitted = true;
+    } else if ( kind == TCPOptionSACK and body_len % SACKBlockLen == 0 ) {
+      for ( ; body_len > 0; body_len -= SACKBlockLen ) {
+        uint32_t left {};
+        uint32_t right {};
+        parser.integer( left );
+        parser.integer( right );
+        if ( seg.receiver_message.ackno.has_value() ) {
+          seg.receiver_message.sack_blocks.push_back( { Wrap32 { left }, Wrap32 { right } } );
+        }
+      }
+    }
+    parser.remove_prefix( body_len );
+  }
+  parser.remove_prefix( options_len );
+}
+
 void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum )
 {
   {
@@ -52,11 +108,11 @@ void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum
   parser.integer( udinfo.cksum );
   parser.integer( raw16 ); // urgent pointer
 
-  // skip any options or anything extra in the header
   if ( data_offset < TCPHeaderMinLen ) {
     parser.set_error();
+    return;
   }
-  parser.remove_prefix( data_offset * 4 - TCPHeaderMinLen * 4 );
+  parse_options( parser, data_offset * 4 - TCPHeaderMinLen * 4, *this );
 
   parser.all_remaining( sender_message.payload );
 }
@@ -67,19 +123,83 @@ public:
   uint32_t raw_value() const { return raw_value_; }
 };
 
+namespace {
+
+// which options a segment carries
+struct TCPOptions
+{
+  bool mss;
+  bool sack_permitted;
+  size_t sack_blocks;
+
+  explicit TCPOptions( const TCPSegment& seg )
+    : mss( seg.sender_message.SYN and seg.mss.has_value() )
+    , sack_permitted( seg.sender_message.SYN and seg.sack_permitted )
+    , sack_blocks( seg.receiver_message.ackno.has_value()
+                     ? min( seg.receiver_message.sack_blocks.size(), max_sack_blocks( mss, sack_permitted ) )
+                     : 0 )
+  {}
+
+  // as many SACK blocks as fit in the option space the other options leave (3 next to both of them on a SYN)
+  static size_t max_sack_blocks( bool mss, bool sack_permitted )
+  {
+    const size_t room = TCPMaxOptionsLen - ( mss ? 4 : 0 ) - ( sack_permitted ? 4 : 0 ) - 4;
+    return min( room / SACKBlockLen, TCPReceiverMessage::MAX_SACK_BLOCKS );
+  }
+
+  // each option is padded to a multiple of 4 bytes with leading NOPs
+  size_t length() const
+  {
+    return ( mss ? 4 : 0 ) + ( sack_permitted ? 4 : 0 ) + ( sack_blocks ? 4 + sack_blocks * SACKBlockLen : 0 );
+  }
+};
+
+} // namespace
+
+uint32_t TCPSegment::header_length() const
+{
+  return TCPHeaderMinLen * 4 + TCPOptions { *this }.length();
+}
+
 void TCPSegment::serialize( Serializer& serializer ) const
 {
+  const TCPOptions options { *this };
+  const size_t options_len = options.length();
+
   serializer.integer( udinfo.src_port );
   serializer.integer( udinfo.dst_port );
   serializer.integer( Wrap32Serializable { sender_message.seqno }.raw_value() );
   serializer.integer( Wrap32Serializable { receiver_message.ackno.value_or( Wrap32 { 0 } ) }.raw_value() );
-  serializer.integer( uint8_t { TCPHeaderMinLen << 4 } ); // data offset
+  serializer.integer( static_cast<uint8_t>( ( TCPHeaderMinLen + options_len / 4 ) << 4 ) ); // data offset
   const uint8_t flags = ( receiver_message.ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
                         | ( sender_message.SYN ? 0b0000'0010U : 0 ) | ( sender_message.FIN ? 0b0000'0001U : 0 );
   serializer.integer( flags );
   serializer.integer( receiver_message.window_size );
   serializer.integer( udinfo.cksum );
   serializer.integer( uint16_t { 0 } ); // urgent pointer
+
+  if ( options.mss ) {
+    serializer.integer( TCPOptionMSS );
+    serializer.integer( uint8_t { 4 } );
+    serializer.integer( mss.value() );
+  }
+  if ( options.sack_permitted ) {
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionSACKPermitted );
+    serializer.integer( uint8_t { 2 } );
+  }
+  if ( options.sack_blocks ) {
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionSACK );
+    serializer.integer( static_cast<uint8_t>( 2 + options.sack_blocks * SACKBlockLen ) );
+    for ( size_t i = 0; i < options.sack_blocks; i++ ) {
+      serializer.integer( Wrap32Serializable { receiver_message.sack_blocks[i].left }.raw_value() );
+      serializer.integer( Wrap32Serializable { receiver_message.sack_blocks[i].right }.raw_value() );
+    }
+  }
+
   serializer.buffer( sender_message.payload );
 }
 
@@ -5,15 +5,23 @@
 #include "tcp_sender_message.hh"
 #include "udinfo.hh"
 
+#include <cstdint>
+#include <optional>
+
 struct TCPSegment
 {
   TCPSenderMessage sender_message {};
   TCPReceiverMessage receiver_message {};
   bool reset {}; // Connection experienced an abnormal error and should be shut down
   UserDatagramInfo udinfo {};
+  bool sack_permitted {};         // SYN option: the sender of this segment understands SACK blocks (RFC 2018)
+  std::optional<uint16_t> mss {}; // SYN option: the largest payload the sender of this segment will accept
+  uint16_t split_size {};         // not sent: split a longer payload into segments this long (0: don't)
 
   void parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum );
   void serialize( Serializer& serializer ) const;
 
+  uint32_t header_length() const; // in bytes, including options
+
   void compute_checksum( uint32_t datagram_layer_pseudo_checksum );
 };
@@ -17,6 +17,14 @@ optional<TCPSegment> TCPOverIPv4OverTunFdAdapter::read()
   return {};
 }
 
+//! \param[in] seg the TCPSegment to send
+void TCPOverIPv4OverTunFdAdapter::write( TCPSegment& seg )
+{
+  for ( const auto& ip_dgram : wrap_tcp_in_ip( seg ) ) {
+    _tun.write( serialize( ip_dgram ) );
+  }
+}
+
 //! \param[in] tap Raw network device that will be owned by the adapter
 //! \param[in] eth_address Ethernet address (local address) of the adapter
 //! \param[in] ip_address IP address (local address) of the adapter
@@ -71,7 +79,9 @@ void TCPOverIPv4OverEthernetAdapter::tick( const size_t ms_since_last_tick )
 //! \param[in] seg the TCPSegment to send
 void TCPOverIPv4OverEthernetAdapter::write( TCPSegment& seg )
 {
-  _interface.send_datagram( wrap_tcp_in_ip( seg ), _next_hop );
+  for ( const auto& ip_dgram : wrap_tcp_in_ip( seg ) ) {
+    _interface.send_datagram( ip_dgram, _next_hop );
+  }
   send_pending();
 }
 
@@ -23,8 +23,8 @@ public:
   //! Attempts to read and parse an IPv4 datagram containing a TCP segment related to the current connection
   std::optional<TCPSegment> read();
 
-  //! Creates an IPv4 datagram from a TCP segment and writes it to the TUN device
-  void write( TCPSegment& seg ) { _tun.write( serialize( wrap_tcp_in_ip( seg ) ) ); }
+  //! Creates IPv4 datagrams from a TCP segment and writes them to the TUN device
+  void write( TCPSegment& seg );
 
   //! Access the underlying TUN device
   explicit operator TunFD&() { return _tun; }